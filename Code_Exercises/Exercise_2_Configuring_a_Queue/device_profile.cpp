@@ -0,0 +1,156 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <device_profile.h>
+
+#include <CL/sycl.hpp>
+
+class profiled_tile;
+
+TEST_CASE("device_profile", "sycl_02_configuring_a_queue") {
+  for (const auto& dev : cl::sycl::device::get_devices()) {
+    const auto& profile = cppcon::device_profile::get(dev);
+
+    std::cout << profile.to_json() << "\n";
+
+    REQUIRE(profile.name == dev.get_info<cl::sycl::info::device::name>());
+    REQUIRE(profile.computeUnits > 0);
+    REQUIRE(profile.maxWorkGroupSize > 0);
+    REQUIRE(profile.maxWorkItemSizes[0] > 0);
+    REQUIRE(profile.maxMemAllocSize <= profile.globalMemSize);
+
+    /* Later lookups are served from the cache. */
+    REQUIRE(&cppcon::device_profile::get(dev) == &profile);
+  }
+}
+
+TEST_CASE("nd_range_helpers", "sycl_02_configuring_a_queue") {
+  cl::sycl::queue defaultQueue;
+  const auto& profile = cppcon::device_profile::get(defaultQueue.get_device());
+
+  SECTION("preferred_local_range") {
+    auto globalRange = cl::sycl::range<2>(1024, 1024);
+    auto localRange = profile.preferred_local_range(globalRange);
+
+    REQUIRE(profile.is_valid_local_range(globalRange, localRange));
+    REQUIRE(localRange.size() * 2 > profile.maxWorkGroupSize);
+
+    /* As close to square as the limits allow. */
+    REQUIRE(localRange[1] >= localRange[0]);
+    REQUIRE(localRange[1] <= localRange[0] * 2);
+  }
+
+  SECTION("local_memory_limit") {
+    auto globalRange = cl::sycl::range<1>(1 << 20);
+    const size_t localMemPerWorkItem = profile.localMemSize / 4;
+    auto localRange =
+        profile.preferred_local_range(globalRange, localMemPerWorkItem);
+
+    REQUIRE(localRange[0] <= 4);
+    REQUIRE(profile.is_valid_local_range(globalRange, localRange,
+                                         localMemPerWorkItem));
+  }
+
+  SECTION("padded_nd_range") {
+    auto globalRange = cl::sycl::range<1>(1009);
+
+    REQUIRE(profile.preferred_local_range(globalRange)[0] == 1);
+
+    auto ndRange = profile.padded_nd_range(globalRange);
+    REQUIRE(ndRange.get_global_range()[0] >= globalRange[0]);
+    REQUIRE(ndRange.get_local_range()[0] > 1);
+    REQUIRE(profile.is_valid_local_range(ndRange.get_global_range(),
+                                         ndRange.get_local_range()));
+  }
+
+  SECTION("vector_width") {
+    for (int width : {profile.vector_width<float>(),
+                      profile.vector_width<float>(true),
+                      profile.vector_width<double>(),
+                      profile.vector_width<char>()}) {
+      REQUIRE(width >= 1);
+      REQUIRE(width <= 16);
+      REQUIRE((width & (width - 1)) == 0);
+    }
+  }
+}
+
+TEST_CASE("profiled_kernel", "sycl_02_configuring_a_queue") {
+  const size_t width = 1000;
+  const size_t height = 600;
+
+  std::vector<float> output(width * height, 0.0f);
+
+  cl::sycl::queue defaultQueue;
+  const auto& profile = cppcon::device_profile::get(defaultQueue.get_device());
+
+  /* A tiled kernel using a float of local memory per work-item, launched over
+   * a padded nd_range as neither dimension is a power of two. */
+  auto ndRange =
+      profile.padded_nd_range(cl::sycl::range<2>(height, width), sizeof(float));
+
+  std::cout << "Launching " << ndRange.get_global_range()[0] << "x"
+            << ndRange.get_global_range()[1] << " in work-groups of "
+            << ndRange.get_local_range()[0] << "x"
+            << ndRange.get_local_range()[1] << "\n";
+
+  {
+    cl::sycl::buffer<float, 2> outputBuf(output.data(),
+                                         cl::sycl::range<2>(height, width));
+
+    defaultQueue.submit([&](cl::sycl::handler& cgh) {
+      auto outputAcc =
+          outputBuf.get_access<cl::sycl::access::mode::discard_write>(cgh);
+      auto tile =
+          cl::sycl::accessor<float, 1, cl::sycl::access::mode::read_write,
+                             cl::sycl::access::target::local>(
+              cl::sycl::range<1>(ndRange.get_local_range().size()), cgh);
+
+      cgh.parallel_for<profiled_tile>(ndRange, [=](cl::sycl::nd_item<2> item) {
+        auto row = item.get_global_id(0);
+        auto col = item.get_global_id(1);
+        auto localId = item.get_local_linear_id();
+
+        tile[localId] = static_cast<float>(row * width + col);
+
+        item.barrier(cl::sycl::access::fence_space::local_space);
+
+        if (row < height && col < width) {
+          outputAcc[row][col] = tile[localId];
+        }
+      });
+    });
+  }
+
+  bool correct = true;
+  for (size_t i = 0; i < output.size(); ++i) {
+    correct = correct && output[i] == static_cast<float>(i);
+  }
+  REQUIRE(correct);
+}
+
+TEST_CASE("profile_query_time", "sycl_02_configuring_a_queue") {
+  auto dev = cl::sycl::queue{}.get_device();
+  cppcon::device_profile::get(dev);
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("query", cppcon::benchmark(
+    [&]() { cppcon::device_profile::query(dev); }, 100, "query"));
+
+  results.emplace_back("cached", cppcon::benchmark(
+    [&]() { cppcon::device_profile::get(dev); }, 100, "cached"));
+
+  cppcon::print_comparison(results, "device profile");
+}
@@ -0,0 +1,109 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <performance_selector.h>
+
+#include <CL/sycl.hpp>
+
+#include <cstdio>
+
+static const char* cachePath = "sycl_02_device_scores_test.txt";
+
+TEST_CASE("performance_selector", "sycl_02_configuring_a_queue") {
+  std::remove(cachePath);
+
+  cppcon::performance_selector selector{cppcon::performance_weights{},
+                                        cachePath};
+
+  cl::sycl::queue perfQueue(selector);
+
+  std::cout << "Performance selector chose: "
+            << perfQueue.get_device().get_info<cl::sycl::info::device::name>()
+            << "\n";
+
+  for (const auto& dev : cl::sycl::device::get_devices()) {
+    auto perf = selector.performance(dev);
+
+    std::cout << "  " << dev.get_info<cl::sycl::info::device::name>()
+              << ": launch latency " << perf.launchLatencyUs << "us, bandwidth "
+              << perf.bandwidthGBs << "GB/s, compute " << perf.computeGFlops
+              << "GFLOPS, score " << selector(dev) << "\n";
+
+    REQUIRE(perf.launchLatencyUs > 0.0);
+    REQUIRE(perf.bandwidthGBs > 0.0);
+    REQUIRE(perf.computeGFlops > 0.0);
+    REQUIRE(selector(perfQueue.get_device()) >= selector(dev));
+  }
+
+  /* Every device has been measured once, by this selector, although identical
+   * devices share a measurement. */
+  REQUIRE(selector.measured() >= 1);
+  REQUIRE(selector.measured() <= cl::sycl::device::get_devices().size());
+
+  /* A later selector finds every device in the cache, and agrees. */
+  cppcon::performance_selector cachedSelector{cppcon::performance_weights{},
+                                              cachePath};
+
+  cl::sycl::queue cachedQueue(cachedSelector);
+
+  REQUIRE(cachedSelector.measured() == 0);
+  REQUIRE(cachedQueue.get_device() == perfQueue.get_device());
+
+  std::remove(cachePath);
+}
+
+TEST_CASE("performance_weights", "sycl_02_configuring_a_queue") {
+  cppcon::device_performance lowLatency{1.0, 5.0, 50.0};
+  cppcon::device_performance highBandwidth{50.0, 100.0, 50.0};
+
+  cppcon::performance_weights latencyBound{1.0, 0.0, 0.0};
+  cppcon::performance_weights bandwidthBound{0.0, 1.0, 0.0};
+
+  using cppcon::performance_selector;
+
+  REQUIRE(performance_selector::score(lowLatency, latencyBound) >
+          performance_selector::score(highBandwidth, latencyBound));
+  REQUIRE(performance_selector::score(highBandwidth, bandwidthBound) >
+          performance_selector::score(lowLatency, bandwidthBound));
+}
+
+TEST_CASE("selection_time", "sycl_02_configuring_a_queue") {
+  std::remove(cachePath);
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("measured", cppcon::benchmark(
+    [&]() {
+      std::remove(cachePath);
+      cppcon::performance_selector selector{cppcon::performance_weights{},
+                                            cachePath};
+      cl::sycl::queue perfQueue(selector);
+    },
+    3, "measured"));
+
+  results.emplace_back("cached", cppcon::benchmark(
+    [&]() {
+      cppcon::performance_selector selector{cppcon::performance_weights{},
+                                            cachePath};
+      cl::sycl::queue perfQueue(selector);
+    },
+    3, "cached"));
+
+  results.emplace_back("default_selector", cppcon::benchmark(
+    [&]() { cl::sycl::queue defaultQueue; }, 3, "default_selector"));
+
+  cppcon::print_comparison(results, "queue construction");
+
+  std::remove(cachePath);
+}
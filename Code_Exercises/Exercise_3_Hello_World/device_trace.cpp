@@ -0,0 +1,210 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <device_trace.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <CL/sycl.hpp>
+
+enum trace_tag : std::uint32_t { where_am_i, checksum };
+
+class trace_ids;
+class trace_every_id;
+class trace_wrap;
+
+TEST_CASE("trace_print_ids", "sycl_03_hello_world") {
+  cl::sycl::default_selector selector;
+
+  cl::sycl::queue myQueue(selector);
+
+  cppcon::device_trace<> trace{16};
+  trace.set_format(where_am_i, "I am on {id}");
+
+  myQueue.submit([&](cl::sycl::handler& cgh) {
+    auto log = trace.get_writer(cgh);
+
+    cgh.parallel_for<trace_ids>(cl::sycl::range<1>(1024),
+      [=](cl::sycl::id<1> idx) {
+        if (idx[0] == 999) {
+          log.log(where_am_i, idx[0]);
+        }
+      });
+    });
+
+  std::ostringstream output;
+  trace.print(output);
+  std::cout << output.str();
+
+  REQUIRE(output.str() == "I am on 999\n");
+}
+
+TEST_CASE("trace_every_id", "sycl_03_hello_world") {
+  const size_t size = 1024;
+
+  cl::sycl::queue myQueue;
+
+  cppcon::device_trace<> trace{size};
+
+  myQueue.submit([&](cl::sycl::handler& cgh) {
+    auto log = trace.get_writer(cgh);
+
+    cgh.parallel_for<trace_every_id>(cl::sycl::range<1>(size),
+      [=](cl::sycl::id<1> idx) {
+        log.log(checksum, idx[0], static_cast<int>(idx[0] * 2));
+      });
+    });
+
+  auto records = trace.records();
+
+  REQUIRE(records.size() == size);
+  REQUIRE(trace.dropped() == 0);
+
+  /* Records arrive in whatever order the work-items ran, but each work-item
+   * appears exactly once. */
+  std::vector<int> seen(size, 0);
+  bool valuesCorrect = true;
+  for (const auto& record : records) {
+    ++seen[record.id];
+    valuesCorrect = valuesCorrect && record.tag == checksum &&
+                    record.values[0] == static_cast<int>(record.id * 2) &&
+                    record.values[1] == 0;
+  }
+  REQUIRE(valuesCorrect);
+  REQUIRE(static_cast<size_t>(std::count(seen.begin(), seen.end(), 1)) ==
+          size);
+}
+
+TEST_CASE("trace_wrap", "sycl_03_hello_world") {
+  cl::sycl::queue myQueue;
+
+  cppcon::device_trace<float, 1> trace{4};
+  trace.set_format(checksum, "{id}: {}");
+
+  /* Single work-items in an in order sequence of kernels, so which records
+   * survive is deterministic. */
+  for (int k = 0; k < 10; ++k) {
+    myQueue.submit([&](cl::sycl::handler& cgh) {
+      auto log = trace.get_writer(cgh);
+      cgh.single_task<trace_wrap>([=]() { log.log(checksum, k, k * 0.5f); });
+    });
+    myQueue.wait_and_throw();
+  }
+
+  auto records = trace.records();
+
+  REQUIRE(trace.count() == 10);
+  REQUIRE(trace.dropped() == 6);
+  REQUIRE(records.size() == 4);
+  REQUIRE(trace.format(records.front()) == "6: 3");
+  REQUIRE(trace.format(records.back()) == "9: 4.5");
+
+  trace.reset();
+  REQUIRE(trace.records().empty());
+}
+
+/* The same kernel, some arithmetic per work-item, with no diagnostics, with
+ * a trace record or with a stream write from every 4096th work-item, and
+ * with a trace record from every work-item. */
+enum class diagnostics { none, trace, stream, trace_all };
+
+template <diagnostics D>
+class diagnosed_kernel;
+
+static float some_arithmetic(float value) {
+  for (int i = 0; i < 16; ++i) {
+    value = value * 0.5f + 1.0f;
+  }
+  return value;
+}
+
+/* Each variant only sets up the diagnostics it uses, so that the baseline
+ * pays for neither a stream nor the trace accessors. */
+template <diagnostics D>
+void run_diagnosed(cl::sycl::queue& queue, cl::sycl::buffer<float, 1>& buf,
+                   cppcon::device_trace<float, 1>& trace) {
+  queue.submit([&](cl::sycl::handler& cgh) {
+    auto acc = buf.get_access<cl::sycl::access::mode::read_write>(cgh);
+
+    if constexpr (D == diagnostics::none) {
+      cgh.parallel_for<diagnosed_kernel<D>>(buf.get_range(),
+        [=](cl::sycl::id<1> idx) { acc[idx] = some_arithmetic(acc[idx]); });
+    } else if constexpr (D == diagnostics::stream) {
+      cl::sycl::stream os(65536, 80, cgh);
+
+      cgh.parallel_for<diagnosed_kernel<D>>(buf.get_range(),
+        [=](cl::sycl::id<1> idx) {
+          auto value = some_arithmetic(acc[idx]);
+          acc[idx] = value;
+          if (idx[0] % 4096 == 0) {
+            os << idx[0] << ": " << value << "\n";
+          }
+        });
+    } else {
+      auto log = trace.get_writer(cgh);
+
+      cgh.parallel_for<diagnosed_kernel<D>>(buf.get_range(),
+        [=](cl::sycl::id<1> idx) {
+          auto value = some_arithmetic(acc[idx]);
+          acc[idx] = value;
+          if (D == diagnostics::trace_all || idx[0] % 4096 == 0) {
+            log.log(checksum, idx[0], value);
+          }
+        });
+    }
+  });
+  queue.wait_and_throw();
+}
+
+TEST_CASE("trace_overhead", "sycl_03_hello_world") {
+  const size_t size = 1 << 20;
+  const int iterations = 20;
+
+  cl::sycl::queue myQueue;
+
+  std::vector<float> data(size, 1.0f);
+  cl::sycl::buffer<float, 1> buf(data.data(), cl::sycl::range<1>(size));
+  cppcon::device_trace<float, 1> trace{size};
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("no diagnostics", cppcon::benchmark(
+    [&]() { run_diagnosed<diagnostics::none>(myQueue, buf, trace); },
+    iterations, "no diagnostics"));
+
+  /* The trace is reset before each benchmark rather than in every run, which
+   * would time a blocking host accessor for the trace variants only, so the
+   * records of each run are counted from the total. A run which doesn't
+   * exceed the capacity by itself only overwrites records of earlier runs. */
+  trace.reset();
+  results.emplace_back("trace, 1/4096", cppcon::benchmark(
+    [&]() { run_diagnosed<diagnostics::trace>(myQueue, buf, trace); },
+    iterations, "trace, 1/4096"));
+  REQUIRE(trace.count() == iterations * (size / 4096));
+
+  results.emplace_back("stream, 1/4096", cppcon::benchmark(
+    [&]() { run_diagnosed<diagnostics::stream>(myQueue, buf, trace); },
+    iterations, "stream, 1/4096"));
+
+  trace.reset();
+  results.emplace_back("trace, every work-item", cppcon::benchmark(
+    [&]() { run_diagnosed<diagnostics::trace_all>(myQueue, buf, trace); },
+    iterations, "trace, every work-item"));
+  REQUIRE(trace.count() == iterations * size);
+  REQUIRE(trace.count() / iterations <= trace.capacity());
+
+  cppcon::print_comparison(results, "diagnostics overhead (" +
+    std::to_string(size) + " work-items)");
+}
@@ -0,0 +1,92 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <async_result.h>
+#include <benchmark.h>
+#include <vector_add.h>
+
+#include <CL/sycl.hpp>
+
+#include <numeric>
+
+TEST_CASE("add_floats_async", "sycl_04_vector_add") {
+  const int size = 1024;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+  std::fill(begin(output), end(output), 0.0f);
+
+  cl::sycl::queue defaultQueue;
+
+  auto result =
+    cppcon::parallel_add_async(defaultQueue, inputA, inputB, output);
+
+  REQUIRE(result.valid());
+
+  result.wait();
+
+  REQUIRE(!result.valid());
+
+  for (int i = 0; i < size; i++) {
+    REQUIRE(output[i] == static_cast<float>(i * 2.0f));
+  }
+}
+
+TEST_CASE("independent_adds", "sycl_04_vector_add") {
+  const int size = 1 << 16;
+  const int count = 64;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<std::vector<float>> outputs(count, std::vector<float>(size));
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  cl::sycl::queue defaultQueue;
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("synchronous", cppcon::benchmark(
+    [&]() {
+      for (auto& output : outputs) {
+        cppcon::parallel_add(defaultQueue, inputA, inputB, output);
+      }
+    },
+    10, "synchronous"));
+
+  results.emplace_back("async", cppcon::benchmark(
+    [&]() {
+      std::vector<cppcon::async_result> pending;
+      for (auto& output : outputs) {
+        pending.push_back(
+          cppcon::parallel_add_async(defaultQueue, inputA, inputB,
+                                     output));
+      }
+      for (auto& result : pending) {
+        result.wait();
+      }
+    },
+    10, "async"));
+
+  for (auto& output : outputs) {
+    REQUIRE(output[size - 1] == static_cast<float>((size - 1) * 2.0f));
+  }
+
+  cppcon::print_comparison(results, std::to_string(count) +
+    " independent adds (" + std::to_string(size) + " floats)");
+}
@@ -0,0 +1,248 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <execution_context.h>
+#include <vector_add.h>
+
+#include <CL/sycl.hpp>
+
+#include <iomanip>
+#include <numeric>
+#include <utility>
+
+/* Measures where the time to the first result of a vector add goes, and how
+ * much of it warm_up can take off the critical path. The runtime caches
+ * platform and device discovery for the lifetime of the process, so the
+ * breakdown is only cold for the first test case, which Catch runs first. */
+
+class first_add;
+
+/* The kernel of cppcon::parallel_add with an execution_context. */
+template <typename T>
+using add_warm = cppcon::vector_add_context_kernel<T>;
+
+template <typename T>
+class scale_warm;
+
+template <typename T>
+class fill_warm;
+
+template <typename Func>
+auto time_once(Func&& func) {
+  auto start = std::chrono::steady_clock::now();
+  auto result = func();
+  std::chrono::duration<double, std::milli> time =
+      std::chrono::steady_clock::now() - start;
+  return std::make_pair(result, time);
+}
+
+static void print_phases(const std::vector<cppcon::benchmark_result>& phases,
+                         std::string caption) {
+  std::chrono::duration<double, std::milli> total{0};
+  for (const auto& phase : phases) {
+    total += phase.time;
+  }
+
+  const auto precision = std::cout.precision();
+  std::cout << caption << "\n";
+  for (const auto& phase : phases) {
+    std::cout << "  " << std::left << std::setw(24) << phase.name
+              << std::right << std::setw(12) << phase.time.count() << "ms"
+              << std::setw(9) << std::setprecision(3)
+              << (100.0 * phase.time / total) << "%\n";
+  }
+  std::cout << "  " << std::left << std::setw(24) << "total" << std::right
+            << std::setw(12) << total.count() << "ms\n\n";
+  std::cout.precision(precision);
+}
+
+TEST_CASE("first_launch_breakdown", "sycl_04_vector_add") {
+  using namespace cl::sycl;
+
+  const size_t size = 1024;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size, 0.0f);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  std::vector<cppcon::benchmark_result> phases;
+
+  auto discovery =
+      time_once([]() { return default_selector{}.select_device(); });
+  auto dev = discovery.first;
+  phases.emplace_back("device discovery", discovery.second);
+
+  auto created = time_once([&]() { return context{dev}; });
+  auto ctx = created.first;
+  phases.emplace_back("context creation", created.second);
+
+  auto queued = time_once([&]() { return queue{ctx, dev}; });
+  auto q = queued.first;
+  phases.emplace_back("queue creation", queued.second);
+
+#ifndef __HIPSYCL__
+  auto built = time_once([&]() {
+    program prog{ctx};
+    prog.build_with_kernel_type<first_add>();
+    return prog.get_kernel<first_add>();
+  });
+  auto kernel = built.first;
+  phases.emplace_back("program build", built.second);
+#endif  // __HIPSYCL__
+
+  auto add = [&]() {
+    cppcon::tracked_buffer<float, 1> inputABuf(inputA.data(), range<1>(size));
+    cppcon::tracked_buffer<float, 1> inputBBuf(inputB.data(), range<1>(size));
+    cppcon::tracked_buffer<float, 1> outputBuf(output.data(), range<1>(size));
+
+    q.submit([&](handler& cgh) {
+      auto inputAAcc = inputABuf.get_access<access::mode::read>(cgh);
+      auto inputBAcc = inputBBuf.get_access<access::mode::read>(cgh);
+      auto outputAcc = outputBuf.get_access<access::mode::write>(cgh);
+
+      auto addFunc = [=](id<1> i) {
+        outputAcc[i] = inputAAcc[i] + inputBAcc[i];
+      };
+#ifndef __HIPSYCL__
+      cgh.parallel_for<first_add>(kernel, range<1>(size), addFunc);
+#else
+      cgh.parallel_for<first_add>(range<1>(size), addFunc);
+#endif  // __HIPSYCL__
+    });
+    return true;
+  };
+
+  phases.emplace_back("first execution", time_once(add).second);
+
+  REQUIRE(output[size - 1] == static_cast<float>((size - 1) * 2.0f));
+
+  print_phases(phases, "time to first result");
+
+  std::cout << "second execution: " << time_once(add).second.count()
+            << "ms\n\n";
+}
+
+template <typename T>
+void parallel_scale(cppcon::execution_context& ctx, std::vector<T>& data,
+  T factor) {
+  using namespace cl::sycl;
+
+  buffer<T, 1> dataBuf(data.data(), range<1>(data.size()));
+
+  ctx.get_queue().submit([&](handler& cgh) {
+    auto dataAcc = dataBuf.template get_access<access::mode::read_write>(cgh);
+
+    ctx.parallel_for<scale_warm<T>>(cgh, range<1>(data.size()), [=](id<1> i) {
+      dataAcc[i] *= factor;
+      });
+    });
+}
+
+template <typename T>
+void parallel_fill(cppcon::execution_context& ctx, std::vector<T>& data,
+  T value) {
+  using namespace cl::sycl;
+
+  buffer<T, 1> dataBuf(data.data(), range<1>(data.size()));
+
+  ctx.get_queue().submit([&](handler& cgh) {
+    auto dataAcc =
+      dataBuf.template get_access<access::mode::discard_write>(cgh);
+
+    ctx.parallel_for<fill_warm<T>>(cgh, range<1>(data.size()), [=](id<1> i) {
+      dataAcc[i] = value;
+      });
+    });
+}
+
+TEST_CASE("warm_up", "sycl_04_vector_add") {
+  std::vector<float> data(1024);
+
+  cppcon::execution_context ctx;
+
+  auto warm =
+    ctx.warm_up<add_warm<float>, scale_warm<float>, fill_warm<float>>();
+  warm.wait();
+
+#ifndef __HIPSYCL__
+  REQUIRE(ctx.is_built<add_warm<float>>());
+  REQUIRE(ctx.is_built<scale_warm<float>>());
+  REQUIRE(ctx.is_built<fill_warm<float>>());
+  REQUIRE(!ctx.is_built<add_warm<int>>());
+#endif  // __HIPSYCL__
+
+  parallel_fill(ctx, data, 2.0f);
+  parallel_scale(ctx, data, 3.0f);
+
+  REQUIRE(data.front() == 6.0f);
+  REQUIRE(data.back() == 6.0f);
+}
+
+/* Time from creating the execution_context to the first result, with and
+ * without warming up the kernel in the background while the application does
+ * the rest of its startup, here initialising the inputs. Each run uses a new
+ * context, so nothing built by an earlier run is reused. */
+TEST_CASE("cold_vs_warm_first_result", "sycl_04_vector_add") {
+  const size_t size = 1 << 22;
+  const int iterations = 5;
+
+  auto dev = cl::sycl::queue{}.get_device();
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  auto startup = [&]() {
+    std::iota(begin(inputA), end(inputA), 0.0f);
+    std::iota(begin(inputB), end(inputB), 0.0f);
+    std::fill(begin(output), end(output), 0.0f);
+  };
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("cold", cppcon::benchmark(
+    [&]() {
+      cppcon::execution_context ctx{cl::sycl::queue{dev}};
+      startup();
+      cppcon::parallel_add(ctx, inputA, inputB, output);
+    },
+    iterations, "cold"));
+
+  results.emplace_back("warm_up at startup", cppcon::benchmark(
+    [&]() {
+      cppcon::execution_context ctx{cl::sycl::queue{dev}};
+      auto warm = ctx.warm_up<add_warm<float>>();
+      startup();
+      cppcon::parallel_add(ctx, inputA, inputB, output);
+    },
+    iterations, "warm_up at startup"));
+
+  cppcon::execution_context ctx{cl::sycl::queue{dev}};
+  cppcon::parallel_add(ctx, inputA, inputB, output);
+
+  results.emplace_back("steady state", cppcon::benchmark(
+    [&]() {
+      startup();
+      cppcon::parallel_add(ctx, inputA, inputB, output);
+    },
+    iterations, "steady state"));
+
+  REQUIRE(output[size - 1] == static_cast<float>((size - 1) * 2.0f));
+
+  cppcon::print_comparison(results, "time to first result (" +
+    std::to_string(size) + " floats)");
+}
@@ -0,0 +1,102 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <execution_context.h>
+#include <vector_add.h>
+
+#include <CL/sycl.hpp>
+
+#include <numeric>
+
+TEST_CASE("add_floats_reuse", "sycl_04_vector_add") {
+  const int size = 1024;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+  std::fill(begin(output), end(output), 0.0f);
+
+  cppcon::execution_context ctx;
+
+  cppcon::parallel_add(ctx, inputA, inputB, output);
+
+  for (int i = 0; i < size; i++) {
+    REQUIRE(output[i] == static_cast<float>(i * 2.0f));
+  }
+}
+
+TEST_CASE("intermediate_buffer_reuse", "sycl_04_vector_add") {
+  const int size = 1024;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> inputC(size);
+  std::vector<float> temp(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+  std::iota(begin(inputC), end(inputC), 0.0f);
+  std::fill(begin(temp), end(temp), 0.0f);
+  std::fill(begin(output), end(output), 0.0f);
+
+  cppcon::execution_context ctx;
+
+  cppcon::parallel_add(ctx, inputA, inputB, temp);
+
+  cppcon::parallel_add(ctx, temp, inputC, output);
+
+  for (int i = 0; i < size; i++) {
+    REQUIRE(output[i] == static_cast<float>(i * 3.0f));
+  }
+}
+
+TEST_CASE("per_call_latency", "sycl_04_vector_add") {
+  std::vector<cppcon::benchmark_result> results;
+
+  for (int size : {16, 256, 4096}) {
+    std::vector<float> inputA(size);
+    std::vector<float> inputB(size);
+    std::vector<float> output(size);
+
+    std::iota(begin(inputA), end(inputA), 0.0f);
+    std::iota(begin(inputB), end(inputB), 0.0f);
+
+    auto tag = std::to_string(size) + " floats";
+
+    results.emplace_back("new queue, " + tag, cppcon::benchmark(
+      [&]() {
+        cl::sycl::queue defaultQueue;
+        cppcon::parallel_add(defaultQueue, inputA, inputB, output);
+      },
+      100,
+      "new queue, " + tag));
+
+    cppcon::execution_context ctx;
+
+    /* Warm up so the first call's kernel build isn't included. */
+    cppcon::parallel_add(ctx, inputA, inputB, output);
+
+    results.emplace_back("reused, " + tag, cppcon::benchmark(
+      [&]() { cppcon::parallel_add(ctx, inputA, inputB, output); }, 100,
+      "reused, " + tag));
+
+    REQUIRE(output[size - 1] == static_cast<float>((size - 1) * 2.0f));
+  }
+
+  cppcon::print_comparison(results, "parallel_add per-call latency");
+}
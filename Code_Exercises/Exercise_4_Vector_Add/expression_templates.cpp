@@ -0,0 +1,133 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <device_vector.h>
+
+#include <CL/sycl.hpp>
+
+#include <numeric>
+
+TEST_CASE("fused_add_three", "sycl_04_vector_add") {
+  const int size = 1024;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> inputC(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+  std::iota(begin(inputC), end(inputC), 0.0f);
+  std::fill(begin(output), end(output), 0.0f);
+
+  cl::sycl::queue defaultQueue;
+
+  {
+    cppcon::device_vector<float> a(defaultQueue, inputA);
+    cppcon::device_vector<float> b(defaultQueue, inputB);
+    cppcon::device_vector<float> c(defaultQueue, inputC);
+    cppcon::device_vector<float> out(defaultQueue, output);
+
+    /* (A + B) + C in a single kernel, with no temp vector. */
+    out = a + b + c;
+  }
+
+  for (int i = 0; i < size; i++) {
+    REQUIRE(output[i] == static_cast<float>(i * 3.0f));
+  }
+}
+
+TEST_CASE("fused_scale_add", "sycl_04_vector_add") {
+  const int size = 1024;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+  std::fill(begin(output), end(output), 0.0f);
+
+  cl::sycl::queue defaultQueue;
+
+  {
+    cppcon::device_vector<float> a(defaultQueue, inputA);
+    cppcon::device_vector<float> b(defaultQueue, inputB);
+    cppcon::device_vector<float> out(defaultQueue, output);
+
+    out = a * 2.0f + b;
+    out = out - a / 2.0f;
+  }
+
+  for (int i = 0; i < size; i++) {
+    REQUIRE(output[i] == Approx(i * 2.5f));
+  }
+}
+
+/* Checked in release builds too, before anything is submitted. */
+TEST_CASE("fused_size_mismatch", "sycl_04_vector_add") {
+  cl::sycl::queue defaultQueue;
+
+  cppcon::device_vector<float> a(defaultQueue, 1024);
+  cppcon::device_vector<float> b(defaultQueue, 512);
+  cppcon::device_vector<float> out(defaultQueue, 1024);
+
+  REQUIRE_THROWS_AS(out = a + b, std::invalid_argument);
+  REQUIRE_THROWS_AS(out = b * 2.0f, std::invalid_argument);
+}
+
+TEST_CASE("fused_vs_intermediate", "sycl_04_vector_add") {
+  const int size = 1 << 22;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> inputC(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+  std::iota(begin(inputC), end(inputC), 0.0f);
+
+  cl::sycl::queue defaultQueue;
+
+  std::vector<cppcon::benchmark_result> results;
+
+  {
+    cppcon::device_vector<float> a(defaultQueue, inputA);
+    cppcon::device_vector<float> b(defaultQueue, inputB);
+    cppcon::device_vector<float> c(defaultQueue, inputC);
+    cppcon::device_vector<float> temp(defaultQueue, size);
+    cppcon::device_vector<float> out(defaultQueue, output);
+
+    results.emplace_back("intermediate", cppcon::benchmark(
+      [&]() {
+        temp = a + b;
+        out = temp + c;
+        defaultQueue.wait_and_throw();
+      },
+      100, "intermediate"));
+
+    results.emplace_back("fused", cppcon::benchmark(
+      [&]() {
+        out = a + b + c;
+        defaultQueue.wait_and_throw();
+      },
+      100, "fused"));
+  }
+
+  REQUIRE(output[size - 1] == static_cast<float>((size - 1) * 3.0f));
+
+  cppcon::print_comparison(results, "(A + B) + C (" + std::to_string(size) +
+    " floats)");
+}
@@ -0,0 +1,126 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <half_storage.h>
+#include <host_baseline.h>
+
+#include <CL/sycl.hpp>
+
+/* Values spread over most of half's range, with fractional parts that half
+ * can't represent exactly. */
+static std::vector<float> make_input(size_t size, float scale) {
+  std::vector<float> input(size);
+  for (size_t i = 0; i < size; ++i) {
+    input[i] = static_cast<float>(i % 30011) * scale;
+  }
+  return input;
+}
+
+TEST_CASE("half_conversion", "sycl_04_vector_add") {
+  auto values = make_input(100000, 0.9931f);
+  values.push_back(0.0f);
+  values.push_back(-1.5f);
+  values.push_back(65504.0f);
+
+  auto roundTrip = cppcon::to_float(cppcon::to_half(values));
+
+  REQUIRE(cppcon::max_relative_error(roundTrip, values) <=
+          cppcon::half_epsilon / 2);
+  REQUIRE(roundTrip[values.size() - 2] == -1.5f);
+  REQUIRE(roundTrip.back() == 65504.0f);
+
+  /* Beyond half's range. */
+  REQUIRE(std::isinf(static_cast<float>(
+      cppcon::to_half(std::vector<float>{1e6f}).front())));
+}
+
+TEST_CASE("half_add_accuracy", "sycl_04_vector_add") {
+  const size_t size = 100000;
+
+  auto inputA = make_input(size, 0.7f);
+  auto inputB = make_input(size, 0.3f);
+  std::vector<float> expected(size);
+  cppcon::host::serial_add(inputA, inputB, expected);
+
+  cl::sycl::queue defaultQueue;
+
+  auto result = cppcon::with_storage(
+      defaultQueue.get_device(), cppcon::storage_precision::half,
+      [&](auto storage) {
+        using Storage = decltype(storage);
+
+        auto inputAData = cppcon::convert_storage<Storage>(inputA);
+        auto inputBData = cppcon::convert_storage<Storage>(inputB);
+        std::vector<Storage> outputData(size);
+        {
+          cl::sycl::buffer<Storage, 1> inputABuf(inputAData.data(), size);
+          cl::sycl::buffer<Storage, 1> inputBBuf(inputBData.data(), size);
+          cl::sycl::buffer<Storage, 1> outputBuf(outputData.data(), size);
+          cppcon::stored_add(defaultQueue, inputABuf, inputBBuf, outputBuf);
+        }
+        return cppcon::convert_storage<float>(outputData);
+      });
+
+  /* Both inputs are positive, so their rounding errors are each at most
+   * half_epsilon / 2 of the sum, as is the rounding of the sum. */
+  const auto error = cppcon::max_relative_error(result, expected);
+  std::cout << "half storage max relative error: " << error << "\n";
+  REQUIRE(error <= 1.5f * cppcon::half_epsilon);
+}
+
+TEST_CASE("half_storage_fallback", "sycl_04_vector_add") {
+  cl::sycl::queue defaultQueue;
+  auto dev = defaultQueue.get_device();
+
+  REQUIRE(cppcon::select_storage(dev, cppcon::storage_precision::single) ==
+          cppcon::storage_precision::single);
+  REQUIRE(cppcon::select_storage(dev, cppcon::storage_precision::half) ==
+          (cppcon::has_fp16(dev) ? cppcon::storage_precision::half
+                                 : cppcon::storage_precision::single));
+
+  auto bytes = cppcon::with_storage(
+      dev, cppcon::storage_precision::half,
+      [](auto storage) { return sizeof(storage); });
+  REQUIRE(bytes == (cppcon::has_fp16(dev) ? 2 : 4));
+}
+
+TEST_CASE("half_add_throughput", "sycl_04_vector_add") {
+  const size_t size = 1 << 24;
+  const int iterations = 20;
+
+  cl::sycl::queue defaultQueue;
+
+  auto inputA = make_input(size, 0.7f);
+  auto inputB = make_input(size, 0.3f);
+
+  /* Two inputs are read and one output written per element. */
+  cppcon::compare_storage_throughput(
+      defaultQueue,
+      "vector add storage (" + std::to_string(size) + " elements)",
+      3.0 * size, iterations, [&](auto storage, auto measure) {
+        using Storage = decltype(storage);
+
+        auto inputAData = cppcon::convert_storage<Storage>(inputA);
+        auto inputBData = cppcon::convert_storage<Storage>(inputB);
+        std::vector<Storage> outputData(size);
+
+        cppcon::tracked_buffer<Storage, 1> inputABuf(inputAData.data(), size);
+        cppcon::tracked_buffer<Storage, 1> inputBBuf(inputBData.data(), size);
+        cppcon::tracked_buffer<Storage, 1> outputBuf(outputData.data(), size);
+
+        measure([&]() {
+          cppcon::stored_add(defaultQueue, inputABuf, inputBBuf, outputBuf);
+        });
+      });
+}
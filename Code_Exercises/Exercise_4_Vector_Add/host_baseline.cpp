@@ -0,0 +1,56 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <host_baseline.h>
+#include <vector_add.h>
+
+#include <CL/sycl.hpp>
+
+#include <numeric>
+
+TEST_CASE("host_baseline_add", "sycl_04_vector_add") {
+  const int size = 1 << 20;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> reference(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("serial", cppcon::benchmark(
+    [&]() { cppcon::host::serial_add(inputA, inputB, reference); }, 100,
+    "serial"));
+
+  std::fill(begin(output), end(output), 0.0f);
+  results.emplace_back("par_unseq", cppcon::benchmark(
+    [&]() { cppcon::host::par_unseq_add(inputA, inputB, output); }, 100,
+    "par_unseq"));
+  REQUIRE(cppcon::host::bit_equal(output, reference));
+
+  /* Created outside the timed region, so that only the add is compared. */
+  cl::sycl::queue defaultQueue;
+
+  std::fill(begin(output), end(output), 0.0f);
+  results.emplace_back("sycl", cppcon::benchmark(
+    [&]() { cppcon::parallel_add(defaultQueue, inputA, inputB, output); },
+    100, "sycl"));
+  REQUIRE(cppcon::host::bit_equal(output, reference));
+
+  cppcon::print_comparison(results, "vector add (" + std::to_string(size) +
+    " floats)");
+}
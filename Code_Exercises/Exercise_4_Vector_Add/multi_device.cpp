@@ -0,0 +1,193 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <partitioned_executor.h>
+#include <vector_add.h>
+
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <mutex>
+#include <numeric>
+
+template <typename T>
+void partitioned_add(cppcon::partitioned_executor& executor,
+  const std::vector<T>& inputA, const std::vector<T>& inputB,
+  std::vector<T>& output, size_t chunkSize = 0) {
+  cppcon::check_vector_add_sizes(inputA, inputB, output);
+
+  auto add = [&](cl::sycl::queue& queue, size_t offset, size_t count) {
+    cppcon::parallel_add(queue, inputA, inputB, output, offset, count);
+  };
+
+  if (chunkSize == 0) {
+    executor.run_static(output.size(), add);
+  } else {
+    executor.run_dynamic(output.size(), chunkSize, add);
+  }
+}
+
+TEST_CASE("partitioned_add", "sycl_04_vector_add") {
+  const int size = 100003;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  /* Two queues on the same device, with uneven weights, exercise the
+   * splitting even where only one device is available. */
+  std::vector<cppcon::partitioned_executor> executors;
+  executors.emplace_back(cppcon::partitioned_executor::all_device_queues());
+  executors.emplace_back(
+    std::vector<cl::sycl::queue>{cl::sycl::queue{}, cl::sycl::queue{}},
+    std::vector<double>{3.0, 1.0});
+
+  for (auto& executor : executors) {
+    for (size_t chunkSize : {0, 1000, 4096}) {
+      std::fill(begin(output), end(output), 0.0f);
+
+      partitioned_add(executor, inputA, inputB, output, chunkSize);
+
+      for (int i = 0; i < size; i++) {
+        REQUIRE(output[i] == static_cast<float>(i * 2.0f));
+      }
+    }
+  }
+}
+
+TEST_CASE("partition_shares", "sycl_04_vector_add") {
+  const size_t size = 10000;
+
+  cppcon::partitioned_executor executor{
+    std::vector<cl::sycl::queue>{cl::sycl::queue{}, cl::sycl::queue{}},
+    std::vector<double>{3.0, 1.0}};
+
+  auto noop = [](cl::sycl::queue&, size_t, size_t) {};
+
+  auto report = executor.run_static(size, noop);
+
+  REQUIRE(report.shares[0].elements == 7500);
+  REQUIRE(report.shares[1].elements == 2500);
+  REQUIRE(report.shares[0].chunks == 1);
+  REQUIRE(report.shares[1].chunks == 1);
+
+  report = executor.run_dynamic(size, 1000, noop);
+
+  REQUIRE(report.shares[0].elements + report.shares[1].elements == size);
+  REQUIRE(report.shares[0].chunks + report.shares[1].chunks >= 10);
+}
+
+TEST_CASE("steal_small_parts", "sycl_04_vector_add") {
+  /* Fewer elements than one chunk per queue, so that chunks are stolen from
+   * parts which end before chunkSize, such as the first. */
+  const size_t chunkSize = 64;
+
+  std::vector<cl::sycl::queue> queues(4);
+  for (auto weights : {std::vector<double>{1.0, 1.0, 1.0, 1.0},
+                       std::vector<double>{8.0, 1.0, 1.0, 1.0},
+                       std::vector<double>{1.0, 1.0, 1.0, 8.0}}) {
+    cppcon::partitioned_executor executor{queues, weights};
+
+    for (size_t size : {1, 7, 40, 100, 255}) {
+      for (int repeat = 0; repeat < 20; ++repeat) {
+        /* Catch's assertions aren't thread safe, so func only records. */
+        std::mutex mutex;
+        std::vector<int> covered(size, 0);
+        bool inBounds = true;
+
+        auto report = executor.run_dynamic(
+          size, chunkSize,
+          [&](cl::sycl::queue&, size_t offset, size_t count) {
+            std::lock_guard<std::mutex> lock{mutex};
+            if (count == 0 || count > chunkSize || offset + count > size) {
+              inBounds = false;
+              return;
+            }
+            for (size_t i = offset; i < offset + count; ++i) {
+              ++covered[i];
+            }
+          });
+
+        REQUIRE(inBounds);
+        REQUIRE(std::all_of(covered.begin(), covered.end(),
+                            [](int c) { return c == 1; }));
+
+        size_t elements = 0;
+        for (const auto& share : report.shares) {
+          elements += share.elements;
+        }
+        REQUIRE(elements == size);
+      }
+    }
+  }
+}
+
+TEST_CASE("partitioned_speedup", "sycl_04_vector_add") {
+  const size_t size = 1 << 24;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  auto queues = cppcon::partitioned_executor::all_device_queues();
+
+  std::vector<cppcon::benchmark_result> results;
+
+  for (auto& queue : queues) {
+    auto name = queue.get_device().get_info<cl::sycl::info::device::name>();
+    results.emplace_back(name, cppcon::benchmark(
+      [&]() { cppcon::parallel_add(queue, inputA, inputB, output); },
+      10, name));
+  }
+
+  cppcon::partitioned_executor executor{queues};
+
+  cppcon::partition_report report;
+  auto add = [&](cl::sycl::queue& queue, size_t offset, size_t count) {
+    cppcon::parallel_add(queue, inputA, inputB, output, offset, count);
+  };
+
+  results.emplace_back("static even split", cppcon::benchmark(
+    [&]() { report = executor.run_static(size, add); }, 10,
+    "static even split"));
+  report.print("static even split");
+
+  results.emplace_back("dynamic", cppcon::benchmark(
+    [&]() { report = executor.run_dynamic(size, size / 64, add); }, 10,
+    "dynamic"));
+  report.print("dynamic");
+
+  /* Split the next runs in proportion to the throughput each device achieved
+   * under dynamic scheduling. */
+  executor.update_weights(report);
+
+  results.emplace_back("static measured split", cppcon::benchmark(
+    [&]() { report = executor.run_static(size, add); }, 10,
+    "static measured split"));
+  report.print("static measured split");
+
+  for (size_t i = 0; i < size; i += size / 16) {
+    REQUIRE(output[i] == static_cast<float>(i * 2.0f));
+  }
+
+  cppcon::print_comparison(results, "partitioned add (" +
+    std::to_string(size) + " floats, " + std::to_string(queues.size()) +
+    " devices)");
+}
@@ -0,0 +1,214 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <numa.h>
+
+#include <CL/sycl.hpp>
+
+class init_flat;
+class add_flat;
+class init_part;
+class add_part;
+
+/* Every element of a is i and of b is 2 * i, so a + b is 3 * i. Values are
+ * kept below 2^24 so they are exact as floats. */
+static float expected(size_t i) { return static_cast<float>(3 * (i % 4096)); }
+
+/* One flat kernel across the whole device, as in the solution. */
+static void flat_init(cl::sycl::queue& queue, cl::sycl::buffer<float, 1>& a,
+  cl::sycl::buffer<float, 1>& b) {
+  using namespace cl::sycl;
+
+  queue.submit([&](handler& cgh) {
+    auto aAcc = a.get_access<access::mode::discard_write>(cgh);
+    auto bAcc = b.get_access<access::mode::discard_write>(cgh);
+
+    cgh.parallel_for<init_flat>(a.get_range(), [=](id<1> i) {
+      aAcc[i] = static_cast<float>(i[0] % 4096);
+      bAcc[i] = static_cast<float>(2 * (i[0] % 4096));
+      });
+    });
+}
+
+static void flat_add(cl::sycl::queue& queue, cl::sycl::buffer<float, 1>& a,
+  cl::sycl::buffer<float, 1>& b, cl::sycl::buffer<float, 1>& r) {
+  using namespace cl::sycl;
+
+  queue.submit([&](handler& cgh) {
+    auto aAcc = a.get_access<access::mode::read>(cgh);
+    auto bAcc = b.get_access<access::mode::read>(cgh);
+    auto rAcc = r.get_access<access::mode::discard_write>(cgh);
+
+    cgh.parallel_for<add_flat>(r.get_range(), [=](id<1> i) {
+      rAcc[i] = aAcc[i] + bAcc[i];
+      });
+    }).wait();
+}
+
+/* Each part is first touched by a kernel on the queue that owns it. */
+static void numa_init(std::vector<cl::sycl::queue>& queues,
+  cppcon::partitioned_buffer<float>& a, cppcon::partitioned_buffer<float>& b) {
+  using namespace cl::sycl;
+
+  cppcon::for_each_part(queues, a, [&](queue& q, size_t p) {
+    auto offset = a.part_offset(p);
+    return q.submit([&](handler& cgh) {
+      auto aAcc = a.get_part(p).get_access<access::mode::discard_write>(cgh);
+      auto bAcc = b.get_part(p).get_access<access::mode::discard_write>(cgh);
+
+      cgh.parallel_for<init_part>(range<1>(a.part_size(p)), [=](id<1> i) {
+        aAcc[i] = static_cast<float>((offset + i[0]) % 4096);
+        bAcc[i] = static_cast<float>(2 * ((offset + i[0]) % 4096));
+        });
+      });
+    });
+}
+
+static void numa_add(std::vector<cl::sycl::queue>& queues,
+  cppcon::partitioned_buffer<float>& a, cppcon::partitioned_buffer<float>& b,
+  cppcon::partitioned_buffer<float>& r) {
+  using namespace cl::sycl;
+
+  cppcon::for_each_part(queues, r, [&](queue& q, size_t p) {
+    return q.submit([&](handler& cgh) {
+      auto aAcc = a.get_part(p).get_access<access::mode::read>(cgh);
+      auto bAcc = b.get_part(p).get_access<access::mode::read>(cgh);
+      auto rAcc = r.get_part(p).get_access<access::mode::discard_write>(cgh);
+
+      cgh.parallel_for<add_part>(range<1>(r.part_size(p)), [=](id<1> i) {
+        rAcc[i] = aAcc[i] + bAcc[i];
+        });
+      });
+    });
+}
+
+TEST_CASE("numa_sub_devices", "sycl_04_vector_add") {
+  for (const auto& dev : cl::sycl::device::get_devices()) {
+    auto subDevices = cppcon::numa_sub_devices(dev);
+
+    REQUIRE(!subDevices.empty());
+    std::cout << dev.get_info<cl::sycl::info::device::name>() << ": "
+              << subDevices.size() << " NUMA sub-device(s)\n";
+
+    if (dev.is_host()) {
+      REQUIRE(subDevices.size() == 1);
+      REQUIRE(subDevices.front() == dev);
+    }
+  }
+}
+
+TEST_CASE("numa_add", "sycl_04_vector_add") {
+  const size_t size = 100003;
+
+  for (const auto& dev : cl::sycl::device::get_devices()) {
+    auto queues = cppcon::numa_queues(dev);
+
+    cppcon::partitioned_buffer<float> a(queues, size);
+    cppcon::partitioned_buffer<float> b(queues, size);
+    cppcon::partitioned_buffer<float> r(queues, size);
+
+    REQUIRE(r.num_parts() == queues.size());
+
+    numa_init(queues, a, b);
+    numa_add(queues, a, b, r);
+
+    std::vector<float> result(size);
+    r.copy_to(result);
+
+    for (size_t i = 0; i < size; i++) {
+      REQUIRE(result[i] == expected(i));
+    }
+  }
+}
+
+/* Fewer elements than parts leaves some parts empty, which are neither
+ * allocated nor launched on. */
+TEST_CASE("numa_add_empty_parts", "sycl_04_vector_add") {
+  const size_t size = 2;
+
+  auto dev = cl::sycl::default_selector{}.select_device();
+  std::vector<cl::sycl::queue> queues(4, cl::sycl::queue{dev});
+
+  cppcon::partitioned_buffer<float> a(queues, size);
+  cppcon::partitioned_buffer<float> b(queues, size);
+  cppcon::partitioned_buffer<float> r(queues, size);
+
+  size_t total = 0;
+  for (size_t p = 0; p < r.num_parts(); ++p) {
+    total += r.part_size(p);
+  }
+  REQUIRE(r.num_parts() == queues.size());
+  REQUIRE(r.part_size(0) == 0);
+  REQUIRE(total == size);
+
+  numa_init(queues, a, b);
+  numa_add(queues, a, b, r);
+
+  std::vector<float> result(size);
+  r.copy_to(result);
+
+  for (size_t i = 0; i < size; i++) {
+    REQUIRE(result[i] == expected(i));
+  }
+}
+
+TEST_CASE("numa_bandwidth", "sycl_04_vector_add") {
+  const size_t size = 1 << 26;
+
+  cl::sycl::queue defaultQueue;
+
+  auto queues = cppcon::numa_queues(defaultQueue.get_device());
+
+  std::vector<cppcon::benchmark_result> results;
+
+  {
+    cl::sycl::buffer<float, 1> a{cl::sycl::range<1>(size)};
+    cl::sycl::buffer<float, 1> b{cl::sycl::range<1>(size)};
+    cl::sycl::buffer<float, 1> r{cl::sycl::range<1>(size)};
+
+    flat_init(defaultQueue, a, b);
+
+    results.emplace_back("flat", cppcon::benchmark(
+      [&]() { flat_add(defaultQueue, a, b, r); }, 10, "flat"));
+
+    auto rAcc = r.get_access<cl::sycl::access::mode::read>();
+    REQUIRE(rAcc[size - 1] == expected(size - 1));
+  }
+
+  {
+    cppcon::partitioned_buffer<float> a(queues, size);
+    cppcon::partitioned_buffer<float> b(queues, size);
+    cppcon::partitioned_buffer<float> r(queues, size);
+
+    numa_init(queues, a, b);
+
+    results.emplace_back("NUMA partitioned", cppcon::benchmark(
+      [&]() { numa_add(queues, a, b, r); }, 10, "NUMA partitioned"));
+
+    std::vector<float> result(size);
+    r.copy_to(result);
+    REQUIRE(result[size - 1] == expected(size - 1));
+  }
+
+  /* Two reads and a write per element. */
+  for (const auto& result : results) {
+    std::cout << result.name << ": "
+              << (3 * size * sizeof(float)) / (result.time.count() * 1e6)
+              << "GB/s\n";
+  }
+
+  cppcon::print_comparison(results, "vector add bandwidth (" +
+    std::to_string(size) + " floats, " + std::to_string(queues.size()) +
+    " NUMA nodes)");
+}
@@ -0,0 +1,216 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <queue_pool.h>
+#include <submission_scaling.h>
+#include <vector_add.h>
+
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+
+using namespace cl::sycl;
+
+/* The inputs and output of each thread's requests, so that threads don't
+ * share host memory. */
+struct thread_data {
+  explicit thread_data(size_t size)
+      : inputA(size), inputB(size), output(size, 0.0f) {
+    std::iota(begin(inputA), end(inputA), 0.0f);
+    std::iota(begin(inputB), end(inputB), 0.0f);
+  }
+
+  std::vector<float> inputA;
+  std::vector<float> inputB;
+  std::vector<float> output;
+};
+
+TEST_CASE("queue_pool", "sycl_04_vector_add") {
+  cppcon::queue_pool pool{default_selector{}.select_device(), 3};
+  REQUIRE(pool.size() == 3);
+
+  for (size_t q = 0; q < pool.size(); ++q) {
+    REQUIRE(pool[q].get_context() == pool.get_context());
+  }
+
+  /* next goes round the queues in turn. */
+  auto* first = &pool.next();
+  auto* second = &pool.next();
+  auto* third = &pool.next();
+  REQUIRE(first != second);
+  REQUIRE(second != third);
+  REQUIRE(&pool.next() == first);
+
+  /* A thread keeps its queue, and threads are spread across the queues. */
+  REQUIRE(&pool.for_this_thread() == &pool.for_this_thread());
+
+  /* Using another pool in between doesn't move the thread on. */
+  {
+    cppcon::queue_pool other{default_selector{}.select_device(), 3};
+    auto* mine = &pool.for_this_thread();
+    auto* theirs = &other.for_this_thread();
+    REQUIRE(&pool.for_this_thread() == mine);
+    REQUIRE(&other.for_this_thread() == theirs);
+  }
+
+  /* Catch's assertions aren't thread safe, so the threads only record, each
+   * to its own element: vector<bool> packs elements into shared words. */
+  std::vector<queue*> threadQueues(pool.size());
+  std::vector<char> kept(pool.size(), false);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threadQueues.size(); ++t) {
+    threads.emplace_back([&, t]() {
+      threadQueues[t] = &pool.for_this_thread();
+      kept[t] = threadQueues[t] == &pool.for_this_thread();
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  REQUIRE(std::count(kept.begin(), kept.end(), 0) == 0);
+  std::set<queue*> distinct(threadQueues.begin(), threadQueues.end());
+  REQUIRE(distinct.size() == pool.size());
+}
+
+TEST_CASE("concurrent_submission", "sycl_04_vector_add") {
+  const size_t size = 1024;
+  const size_t threads = 4;
+  const size_t requests = 8;
+
+  auto dev = default_selector{}.select_device();
+
+  for (auto strategy : {cppcon::submission_strategy::shared_queue,
+                        cppcon::submission_strategy::per_thread_queues,
+                        cppcon::submission_strategy::queue_pool}) {
+    std::vector<thread_data> data(threads, thread_data{size});
+    std::vector<size_t> correct(threads, 0);
+
+    auto result = cppcon::run_submission_scaling(
+        dev, strategy, threads, requests, 2,
+        [&](queue& q, size_t thread, size_t index) {
+          auto& d = data[thread];
+          d.inputA[0] = static_cast<float>(index);
+          cppcon::parallel_add(q, d.inputA, d.inputB, d.output);
+          if (d.output[0] == static_cast<float>(index) &&
+              d.output[size - 1] == static_cast<float>((size - 1) * 2)) {
+            ++correct[thread];
+          }
+        });
+
+    REQUIRE(result.requests == threads * requests);
+    for (auto c : correct) {
+      REQUIRE(c == requests);
+    }
+    REQUIRE(result.queues ==
+            (strategy == cppcon::submission_strategy::shared_queue ? 1
+             : strategy == cppcon::submission_strategy::queue_pool ? 2
+                                                                   : threads));
+    REQUIRE(result.latency.p50Us <= result.latency.p99Us);
+    REQUIRE(result.latency.p99Us <= result.latency.maxUs);
+  }
+}
+
+TEST_CASE("request_exception", "sycl_04_vector_add") {
+  auto dev = default_selector{}.select_device();
+
+  /* A failed request doesn't stop the other threads, and is reported. */
+  REQUIRE_THROWS_AS(
+      cppcon::run_submission_scaling(
+          dev, cppcon::submission_strategy::shared_queue, 4, 4, 1,
+          [](queue&, size_t thread, size_t index) {
+            if (thread == 2 && index == 1) {
+              throw std::runtime_error{"request failed"};
+            }
+          }),
+      std::runtime_error);
+}
+
+TEST_CASE("best_pool_size", "sycl_04_vector_add") {
+  auto result = [](cppcon::submission_strategy strategy, size_t threads,
+                   size_t queues, double elapsedMs) {
+    cppcon::scaling_result r;
+    r.strategy = strategy;
+    r.threads = threads;
+    r.queues = queues;
+    r.requests = 1000;
+    r.elapsed = std::chrono::duration<double, std::milli>{elapsedMs};
+    return r;
+  };
+
+  /* Only queue_pool results count, however fast the others are. */
+  std::vector<cppcon::scaling_result> results = {
+      result(cppcon::submission_strategy::queue_pool, 2, 2, 1.0),
+      result(cppcon::submission_strategy::shared_queue, 8, 1, 5.0),
+      result(cppcon::submission_strategy::per_thread_queues, 8, 8, 5.0),
+      result(cppcon::submission_strategy::queue_pool, 8, 2, 30.0),
+      result(cppcon::submission_strategy::queue_pool, 8, 4, 10.0),
+      result(cppcon::submission_strategy::queue_pool, 8, 8, 20.0)};
+  REQUIRE(cppcon::best_pool_size(results) == 4);
+
+  /* The most threads of the queue_pool results, not of all of them. */
+  results.erase(results.begin() + 3, results.end());
+  REQUIRE(cppcon::best_pool_size(results) == 2);
+
+  results.erase(results.begin());
+  REQUIRE_THROWS_AS(cppcon::best_pool_size(results), std::invalid_argument);
+  REQUIRE_THROWS_AS(cppcon::best_at_most_threads({}), std::invalid_argument);
+}
+
+TEST_CASE("submission_scaling", "sycl_04_vector_add") {
+  /* Small enough that submission, rather than the kernel, dominates. */
+  const size_t size = 1 << 12;
+  const size_t requests = 200;
+
+  auto dev = default_selector{}.select_device();
+  const auto threadCounts = cppcon::scaling_thread_counts();
+
+
+  std::vector<cppcon::scaling_result> results;
+  auto run = [&](cppcon::submission_strategy strategy, size_t threads,
+                 size_t poolSize) {
+    std::vector<thread_data> data(threads, thread_data{size});
+    results.push_back(cppcon::run_submission_scaling(
+        dev, strategy, threads, requests, poolSize,
+        [&](queue& q, size_t thread, size_t) {
+          auto& d = data[thread];
+          cppcon::parallel_add(q, d.inputA, d.inputB, d.output);
+        }));
+    for (const auto& d : data) {
+      REQUIRE(d.output[size - 1] == static_cast<float>((size - 1) * 2));
+    }
+  };
+
+  for (auto threads : threadCounts) {
+    run(cppcon::submission_strategy::shared_queue, threads, 1);
+    run(cppcon::submission_strategy::per_thread_queues, threads, 1);
+    /* Pools of each size up to one queue per thread, for best_pool_size. */
+    for (auto poolSize : threadCounts) {
+      if (poolSize <= threads) {
+        run(cppcon::submission_strategy::queue_pool, threads, poolSize);
+      }
+    }
+  }
+
+  cppcon::print_scaling(results, "vector add submission scaling (" +
+    std::to_string(size) + " floats, " + std::to_string(requests) +
+    " requests per thread)");
+
+  const auto& best = cppcon::best_at_most_threads(results);
+  std::cout << "best at " << best.threads << " threads: "
+            << cppcon::to_string(best.strategy) << ", " << best.queues
+            << " queue(s)\n";
+  std::cout << "queue_pool size for " << best.threads << " threads: "
+            << cppcon::best_pool_size(results) << "\n\n";
+}
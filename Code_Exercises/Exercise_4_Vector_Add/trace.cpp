@@ -0,0 +1,198 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <chrome_trace.h>
+
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+using namespace cl::sycl;
+
+template <typename T>
+class traced_add;
+
+/* The vector add of solution.cpp, with the copies to and from the device
+ * made explicit so that they show up on the timeline. */
+template <typename T>
+void traced_vector_add(cppcon::traced_queue& queue,
+                       const std::vector<T>& inputA,
+                       const std::vector<T>& inputB, std::vector<T>& output) {
+  const auto size = inputA.size();
+
+  buffer<T, 1> inputABuf{range<1>(size)};
+  buffer<T, 1> inputBBuf{range<1>(size)};
+  buffer<T, 1> outputBuf{range<1>(size)};
+
+  queue.submit("copy a", [&](handler& cgh) {
+    auto acc = queue.get_access<access::mode::discard_write>(cgh, inputABuf,
+                                                             "accessor a");
+    cgh.copy(inputA.data(), acc);
+  }, "copy");
+
+  queue.submit("copy b", [&](handler& cgh) {
+    auto acc = queue.get_access<access::mode::discard_write>(cgh, inputBBuf,
+                                                             "accessor b");
+    cgh.copy(inputB.data(), acc);
+  }, "copy");
+
+  queue.submit("vector add", [&](handler& cgh) {
+    auto inputAAcc =
+        queue.get_access<access::mode::read>(cgh, inputABuf, "accessor a");
+    auto inputBAcc =
+        queue.get_access<access::mode::read>(cgh, inputBBuf, "accessor b");
+    auto outputAcc = queue.get_access<access::mode::discard_write>(
+        cgh, outputBuf, "accessor output");
+
+    cgh.parallel_for<traced_add<T>>(range<1>(size), [=](id<1> i) {
+      outputAcc[i] = inputAAcc[i] + inputBAcc[i];
+    });
+  });
+
+  queue.submit("copy output", [&](handler& cgh) {
+    auto acc = queue.get_access<access::mode::read>(cgh, outputBuf,
+                                                    "accessor output");
+    cgh.copy(acc, output.data());
+  }, "copy");
+
+  queue.wait();
+}
+
+static size_t count_spans(const cppcon::trace_timeline& timeline,
+                          const std::string& category) {
+  auto spans = timeline.spans();
+  return std::count_if(spans.begin(), spans.end(),
+                       [&](const cppcon::trace_span& span) {
+                         return span.category == category;
+                       });
+}
+
+/* Writes vector_add.json if SYCL_ACADEMY_TRACE is set. */
+TEST_CASE("traced_vector_add", "sycl_04_vector_add") {
+  const size_t size = 1 << 20;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size, 0.0f);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  cppcon::trace_timeline timeline{"vector_add"};
+  cppcon::traced_queue queue{timeline, default_selector{}.select_device(),
+                             "vector add queue"};
+
+  traced_vector_add(queue, inputA, inputB, output);
+
+  REQUIRE(output[size - 1] == static_cast<float>((size - 1) * 2));
+
+  if (timeline.enabled()) {
+    REQUIRE(timeline.save());
+    std::cout << "trace written to " << timeline.path() << "\n";
+  }
+}
+
+TEST_CASE("vector_add_trace_events", "sycl_04_vector_add") {
+  const size_t size = 1024;
+
+  std::vector<float> inputA(size, 1.0f);
+  std::vector<float> inputB(size, 2.0f);
+  std::vector<float> output(size, 0.0f);
+
+  cppcon::trace_timeline timeline{"vector_add_trace_events", true};
+  cppcon::traced_queue queue{timeline, default_selector{}.select_device(),
+                             "vector add queue"};
+
+  traced_vector_add(queue, inputA, inputB, output);
+  REQUIRE(output[0] == 3.0f);
+
+  /* Four submissions, with an accessor per buffer used by each, and a wait,
+   * on the host; three copies and the kernel on the device. */
+  REQUIRE(count_spans(timeline, "submit") == 4);
+  REQUIRE(count_spans(timeline, "accessor") == 6);
+  REQUIRE(count_spans(timeline, "wait") == 1);
+  REQUIRE(count_spans(timeline, "copy") == 3);
+  REQUIRE(count_spans(timeline, "kernel") == 1);
+
+  for (const auto& span : timeline.spans()) {
+    const bool onDevice = span.category == "copy" || span.category == "kernel";
+    REQUIRE(span.pid == (onDevice ? cppcon::trace_timeline::device_pid
+                                  : cppcon::trace_timeline::host_pid));
+    REQUIRE(span.tid == 1);
+    REQUIRE(span.startUs >= 0.0);
+    REQUIRE(span.durationUs >= 0.0);
+  }
+
+  /* The device spans share one clock offset, so they keep their order: the
+   * kernel follows both input copies, and the output copy the kernel, to
+   * within a nanosecond of rounding. */
+  const auto spans = timeline.spans();
+  auto device_span = [&](const std::string& name) {
+    return *std::find_if(spans.begin(), spans.end(),
+                         [&](const cppcon::trace_span& span) {
+                           return span.name == name &&
+                                  span.pid ==
+                                      cppcon::trace_timeline::device_pid;
+                         });
+  };
+  auto end = [](const cppcon::trace_span& span) {
+    return span.startUs + span.durationUs - 0.001;
+  };
+  const auto kernel = device_span("vector add");
+  REQUIRE(kernel.startUs >= end(device_span("copy a")));
+  REQUIRE(kernel.startUs >= end(device_span("copy b")));
+  REQUIRE(device_span("copy output").startUs >= end(kernel));
+
+  std::ostringstream json;
+  timeline.write_json(json);
+  const auto text = json.str();
+  REQUIRE(text.front() == '{');
+  REQUIRE(text.find("\"traceEvents\":[") != std::string::npos);
+  REQUIRE(text.find("\"name\":\"vector add queue\"") != std::string::npos);
+  REQUIRE(text.find("\"name\":\"host thread 1\"") != std::string::npos);
+
+  size_t completeEvents = 0;
+  for (auto pos = text.find("\"ph\":\"X\""); pos != std::string::npos;
+       pos = text.find("\"ph\":\"X\"", pos + 1)) {
+    ++completeEvents;
+  }
+  REQUIRE(completeEvents == timeline.spans().size());
+}
+
+TEST_CASE("trace_disabled", "sycl_04_vector_add") {
+  const size_t size = 1024;
+
+  std::vector<float> inputA(size, 1.0f);
+  std::vector<float> inputB(size, 2.0f);
+  std::vector<float> output(size, 0.0f);
+
+  const std::string name = "vector_add_trace_disabled";
+  std::remove((name + ".json").c_str());
+
+  {
+    cppcon::trace_timeline timeline{name, false};
+    cppcon::traced_queue queue{timeline, default_selector{}.select_device(),
+                               "vector add queue"};
+
+    traced_vector_add(queue, inputA, inputB, output);
+    REQUIRE(output[0] == 3.0f);
+    REQUIRE(timeline.spans().empty());
+  }
+
+  /* Nothing is written either. */
+  REQUIRE_FALSE(std::ifstream{name + ".json"}.good());
+}
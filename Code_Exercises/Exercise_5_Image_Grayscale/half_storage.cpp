@@ -0,0 +1,89 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <half_storage.h>
+#include <host_baseline.h>
+
+#include <CL/sycl.hpp>
+
+/* A synthetic image is used so the tests do not depend on the location of
+ * dogs.png. */
+static std::vector<float> make_image(size_t width, size_t height) {
+  std::vector<float> image(width * height * 4);
+  for (size_t i = 0; i < image.size(); ++i) {
+    image[i] = static_cast<float>((i * 7) % 256);
+  }
+  return image;
+}
+
+TEST_CASE("half_grayscale_accuracy", "sycl_05_grayscale") {
+  const size_t width = 512;
+  const size_t height = 256;
+
+  auto image = make_image(width, height);
+  auto expected = image;
+  cppcon::host::serial_grayscale(expected);
+
+  cl::sycl::queue defaultQueue;
+
+  auto result = cppcon::with_storage(
+      defaultQueue.get_device(), cppcon::storage_precision::half,
+      [&](auto storage) {
+        using Storage = decltype(storage);
+
+        auto imageData = cppcon::convert_storage<Storage>(image);
+        {
+          cl::sycl::buffer<Storage, 1> imageBuf(imageData.data(),
+                                                imageData.size());
+          cppcon::stored_grayscale(defaultQueue, imageBuf, width, height);
+        }
+        return cppcon::convert_storage<float>(imageData);
+      });
+
+  /* Channel values up to 255 are exact in half, so the only error is in
+   * rounding the luminance, which stays within a grayscale level. */
+  const auto error = cppcon::max_relative_error(result, expected);
+  std::cout << "half storage max relative error: " << error << "\n";
+  REQUIRE(error <= cppcon::half_epsilon / 2);
+  REQUIRE(cppcon::host::equal_within(result, expected, 0.5f));
+}
+
+TEST_CASE("half_grayscale_throughput", "sycl_05_grayscale") {
+  const size_t width = 2048;
+  const size_t height = 2048;
+  const int iterations = 20;
+
+  cl::sycl::queue defaultQueue;
+
+  auto image = make_image(width, height);
+
+  /* Three channels are read and written per pixel. */
+  cppcon::compare_storage_throughput(
+      defaultQueue,
+      "grayscale storage (" + std::to_string(width) + "x" +
+          std::to_string(height) + ")",
+      6.0 * width * height, iterations, [&](auto storage, auto measure) {
+        using Storage = decltype(storage);
+
+        auto imageData = cppcon::convert_storage<Storage>(image);
+        cppcon::tracked_buffer<Storage, 1> imageBuf(imageData.data(),
+                                              imageData.size());
+
+        /* Converting an image which is already gray leaves it as it is, so
+         * the repeated runs are harmless. */
+        measure([&]() {
+          cppcon::stored_grayscale(defaultQueue, imageBuf, width, height);
+        });
+      });
+}
@@ -0,0 +1,100 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <host_baseline.h>
+
+#include <CL/sycl.hpp>
+
+class coalesced;
+
+TEST_CASE("host_baseline_grayscale", "sycl_05_grayscale") {
+  /* A synthetic image is used so the comparison does not depend on the
+   * location of dogs.png. */
+  const int width = 1024;
+  const int height = 1024;
+  const int channels = 4;
+
+  auto size = width * height * channels;
+
+  auto inputData = std::vector<float>(size);
+  for (int i = 0; i < size; ++i) {
+    inputData[i] = static_cast<float>((i * 7) % 256);
+  }
+
+  auto reference = inputData;
+  auto imageData = inputData;
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("serial", cppcon::benchmark(
+    [&]() {
+      reference = inputData;
+      cppcon::host::serial_grayscale(reference);
+    },
+    100, "serial"));
+
+  results.emplace_back("par_unseq", cppcon::benchmark(
+    [&]() {
+      imageData = inputData;
+      cppcon::host::par_unseq_grayscale(imageData);
+    },
+    100, "par_unseq"));
+  REQUIRE(cppcon::host::equal_within(imageData, reference, 1e-3f));
+
+  cl::sycl::queue defaultQueue;
+
+  imageData = inputData;
+  {
+    cppcon::tracked_buffer<float, 1> imageDataBuf(imageData.data(), size);
+
+    results.emplace_back("sycl", cppcon::benchmark(
+      [&]() {
+        /* Each iteration starts from the original colour image so that every
+         * variant does the same work. */
+        defaultQueue.submit([&](cl::sycl::handler& cgh) {
+          auto imageDataAcc =
+            imageDataBuf
+            .template get_access<cl::sycl::access::mode::discard_write>(cgh);
+          cgh.copy(inputData.data(), imageDataAcc);
+          });
+
+        defaultQueue.submit([&](cl::sycl::handler& cgh) {
+          auto imageDataAcc =
+            imageDataBuf
+            .template get_access<cl::sycl::access::mode::read_write>(
+              cgh);
+
+          cgh.parallel_for<coalesced>(
+            cl::sycl::range<2>(width, height), [=](cl::sycl::id<2> idx) {
+              auto linearId =
+                (idx[0] * height * channels) + (idx[1] * channels);
+
+              float y = (imageDataAcc[linearId] * 0.299f) +
+                (imageDataAcc[linearId + 1] * 0.587f) +
+                (imageDataAcc[linearId + 2] * 0.114f);
+              imageDataAcc[linearId] = y;
+              imageDataAcc[linearId + 1] = y;
+              imageDataAcc[linearId + 2] = y;
+            });
+          });
+
+        defaultQueue.wait_and_throw();
+      },
+      100, "sycl"));
+  }
+  REQUIRE(cppcon::host::equal_within(imageData, reference, 1e-3f));
+
+  cppcon::print_comparison(results, "grayscale (" + std::to_string(width) +
+    "x" + std::to_string(height) + " pixels)");
+}
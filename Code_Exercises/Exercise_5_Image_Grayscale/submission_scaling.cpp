@@ -0,0 +1,111 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <host_baseline.h>
+#include <memory_footprint.h>
+#include <queue_pool.h>
+#include <submission_scaling.h>
+
+#include <CL/sycl.hpp>
+
+using namespace cl::sycl;
+
+class scaling_grayscale;
+
+/* A synthetic image is used so the tests do not depend on the location of
+ * dogs.png. */
+static std::vector<float> make_image(size_t width, size_t height) {
+  std::vector<float> image(width * height * 4);
+  for (size_t i = 0; i < image.size(); ++i) {
+    image[i] = static_cast<float>((i * 7) % 256);
+  }
+  return image;
+}
+
+/* A request: the naive grayscale of solution.cpp, on the given queue. */
+static void grayscale(queue& q, std::vector<float>& imageData, size_t width,
+                      size_t height) {
+  constexpr size_t channels = 4;
+
+  cppcon::tracked_buffer<float, 1> imageDataBuf(imageData.data(),
+                                                range<1>(imageData.size()));
+
+  q.submit([&](handler& cgh) {
+    auto imageDataAcc =
+        imageDataBuf.get_access<access::mode::read_write>(cgh);
+
+    cgh.parallel_for<scaling_grayscale>(
+        range<2>(width, height), [=](id<2> idx) {
+          auto linearId = (idx[1] * width * channels) + (idx[0] * channels);
+
+          float y = (imageDataAcc[linearId] * 0.299f) +
+                    (imageDataAcc[linearId + 1] * 0.587f) +
+                    (imageDataAcc[linearId + 2] * 0.114f);
+          imageDataAcc[linearId] = y;
+          imageDataAcc[linearId + 1] = y;
+          imageDataAcc[linearId + 2] = y;
+        });
+  });
+}
+
+TEST_CASE("grayscale_submission_scaling", "sycl_05_grayscale") {
+  /* A thumbnail per request, as an image service would convert. */
+  const size_t width = 128;
+  const size_t height = 128;
+  const size_t requests = 100;
+
+  auto dev = default_selector{}.select_device();
+
+  const auto image = make_image(width, height);
+  auto expected = image;
+  cppcon::host::serial_grayscale(expected);
+
+  const auto threadCounts = cppcon::scaling_thread_counts();
+
+  std::vector<cppcon::scaling_result> results;
+  auto run = [&](cppcon::submission_strategy strategy, size_t threads,
+                 size_t poolSize) {
+    std::vector<std::vector<float>> images(threads);
+    results.push_back(cppcon::run_submission_scaling(
+        dev, strategy, threads, requests, poolSize,
+        [&](queue& q, size_t thread, size_t) {
+          images[thread] = image;
+          grayscale(q, images[thread], width, height);
+        }));
+    for (const auto& result : images) {
+      REQUIRE(cppcon::host::equal_within(result, expected, 0.01f));
+    }
+  };
+
+  for (auto threads : threadCounts) {
+    run(cppcon::submission_strategy::shared_queue, threads, 1);
+    run(cppcon::submission_strategy::per_thread_queues, threads, 1);
+    /* Pools of each size up to one queue per thread, for best_pool_size. */
+    for (auto poolSize : threadCounts) {
+      if (poolSize <= threads) {
+        run(cppcon::submission_strategy::queue_pool, threads, poolSize);
+      }
+    }
+  }
+
+  cppcon::print_scaling(results, "grayscale submission scaling (" +
+    std::to_string(width) + "x" + std::to_string(height) + ", " +
+    std::to_string(requests) + " requests per thread)");
+
+  const auto& best = cppcon::best_at_most_threads(results);
+  std::cout << "best at " << best.threads << " threads: "
+            << cppcon::to_string(best.strategy) << ", " << best.queues
+            << " queue(s)\n";
+  std::cout << "queue_pool size for " << best.threads << " threads: "
+            << cppcon::best_pool_size(results) << "\n\n";
+}
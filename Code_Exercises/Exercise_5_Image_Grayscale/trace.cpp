@@ -0,0 +1,156 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <chrome_trace.h>
+#include <host_baseline.h>
+
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <memory>
+
+using namespace cl::sycl;
+
+class traced_grayscale;
+
+/* A synthetic image is used so the tests do not depend on the location of
+ * dogs.png. */
+static std::vector<float> make_image(size_t width, size_t height) {
+  std::vector<float> image(width * height * 4);
+  for (size_t i = 0; i < image.size(); ++i) {
+    image[i] = static_cast<float>((i * 7) % 256);
+  }
+  return image;
+}
+
+/* Converts the image in bands of rows, each copied to the device, converted
+ * and copied back independently of the others, so that the timeline shows
+ * whether the copies of one band overlap with converting another. */
+static void traced_grayscale_pipeline(cppcon::traced_queue& queue,
+                                      std::vector<float>& image, size_t width,
+                                      size_t height, size_t bands) {
+  constexpr size_t channels = 4;
+  const size_t bandRows = (height + bands - 1) / bands;
+
+  std::vector<std::unique_ptr<buffer<float, 1>>> bandBufs;
+
+  for (size_t band = 0; band * bandRows < height; ++band) {
+    const size_t rows = std::min(bandRows, height - band * bandRows);
+    const size_t count = rows * width * channels;
+    float* bandData = image.data() + band * bandRows * width * channels;
+    const auto suffix = " " + std::to_string(band);
+
+    bandBufs.push_back(std::make_unique<buffer<float, 1>>(range<1>(count)));
+    auto& bandBuf = *bandBufs.back();
+
+    queue.submit("copy in" + suffix, [&](handler& cgh) {
+      auto acc = queue.get_access<access::mode::discard_write>(
+          cgh, bandBuf, "accessor" + suffix);
+      cgh.copy(bandData, acc);
+    }, "copy");
+
+    queue.submit("grayscale" + suffix, [&](handler& cgh) {
+      auto imageDataAcc = queue.get_access<access::mode::read_write>(
+          cgh, bandBuf, "accessor" + suffix);
+
+      cgh.parallel_for<traced_grayscale>(
+          range<2>(rows, width), [=](id<2> idx) {
+            auto linearId = ((idx[0] * width) + idx[1]) * channels;
+
+            float y = (imageDataAcc[linearId] * 0.299f) +
+                      (imageDataAcc[linearId + 1] * 0.587f) +
+                      (imageDataAcc[linearId + 2] * 0.114f);
+            imageDataAcc[linearId] = y;
+            imageDataAcc[linearId + 1] = y;
+            imageDataAcc[linearId + 2] = y;
+          });
+    });
+
+    queue.submit("copy out" + suffix, [&](handler& cgh) {
+      auto acc = queue.get_access<access::mode::read>(cgh, bandBuf,
+                                                      "accessor" + suffix);
+      cgh.copy(acc, bandData);
+    }, "copy");
+  }
+
+  queue.wait();
+}
+
+static size_t count_spans(const cppcon::trace_timeline& timeline,
+                          const std::string& category) {
+  auto spans = timeline.spans();
+  return std::count_if(spans.begin(), spans.end(),
+                       [&](const cppcon::trace_span& span) {
+                         return span.category == category;
+                       });
+}
+
+/* Writes grayscale.json if SYCL_ACADEMY_TRACE is set. */
+TEST_CASE("traced_grayscale", "sycl_05_grayscale") {
+  const size_t width = 2048;
+  const size_t height = 2048;
+  const size_t bands = 8;
+
+  auto image = make_image(width, height);
+  auto expected = image;
+  cppcon::host::serial_grayscale(expected);
+
+  cppcon::trace_timeline timeline{"grayscale"};
+  cppcon::traced_queue queue{timeline, default_selector{}.select_device(),
+                             "grayscale queue"};
+
+  traced_grayscale_pipeline(queue, image, width, height, bands);
+
+  REQUIRE(cppcon::host::equal_within(image, expected, 0.01f));
+
+  if (timeline.enabled()) {
+    REQUIRE(timeline.save());
+    std::cout << "trace written to " << timeline.path() << "\n";
+  }
+}
+
+TEST_CASE("grayscale_trace_events", "sycl_05_grayscale") {
+  /* The last band is shorter than the others. */
+  const size_t width = 64;
+  const size_t height = 50;
+  const size_t bands = 4;
+
+  auto image = make_image(width, height);
+  auto expected = image;
+  cppcon::host::serial_grayscale(expected);
+
+  cppcon::trace_timeline timeline{"grayscale_trace_events", true};
+  cppcon::traced_queue queue{timeline, default_selector{}.select_device(),
+                             "grayscale queue"};
+
+  traced_grayscale_pipeline(queue, image, width, height, bands);
+  REQUIRE(cppcon::host::equal_within(image, expected, 0.01f));
+
+  REQUIRE(count_spans(timeline, "submit") == 3 * bands);
+  REQUIRE(count_spans(timeline, "accessor") == 3 * bands);
+  REQUIRE(count_spans(timeline, "copy") == 2 * bands);
+  REQUIRE(count_spans(timeline, "kernel") == bands);
+  REQUIRE(count_spans(timeline, "wait") == 1);
+
+  /* Every band's device spans are named after it. */
+  auto spans = timeline.spans();
+  for (size_t band = 0; band < bands; ++band) {
+    const auto name = "grayscale " + std::to_string(band);
+    REQUIRE(std::any_of(spans.begin(), spans.end(),
+                        [&](const cppcon::trace_span& span) {
+                          return span.name == name &&
+                                 span.pid ==
+                                     cppcon::trace_timeline::device_pid;
+                        }));
+  }
+}
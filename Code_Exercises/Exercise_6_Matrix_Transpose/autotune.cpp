@@ -0,0 +1,155 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <autotune.h>
+#include <benchmark.h>
+#include <memory_footprint.h>
+
+#include <cstdio>
+#include <numeric>
+
+#include <CL/sycl.hpp>
+
+class tuned_local_mem;
+
+static constexpr int WIDTH = 128;
+static constexpr int HEIGHT = 128;
+
+TEST_CASE("candidates_within_limits", "sycl_06_matrix_transpose") {
+  cl::sycl::queue defaultQueue;
+
+  auto dev = defaultQueue.get_device();
+  auto globalRange = cl::sycl::range<2>(WIDTH, HEIGHT);
+  auto candidates =
+      cppcon::work_group_candidates(dev, globalRange, sizeof(float));
+
+  REQUIRE(!candidates.empty());
+
+  for (auto candidate : candidates) {
+    REQUIRE(candidate[0] * candidate[1] <=
+            dev.get_info<cl::sycl::info::device::max_work_group_size>());
+    REQUIRE(WIDTH % candidate[0] == 0);
+    REQUIRE(HEIGHT % candidate[1] == 0);
+  }
+
+  REQUIRE(!cppcon::is_valid_work_group_size(
+      dev, globalRange, cl::sycl::range<2>(WIDTH * 2, 1)));
+}
+
+TEST_CASE("tuned_local_mem", "sycl_06_matrix_transpose") {
+  std::vector<float> inputMat(WIDTH * HEIGHT);
+  std::vector<float> outputMat(WIDTH * HEIGHT);
+
+  std::iota(inputMat.begin(), inputMat.end(), 0.0f);
+  std::fill(outputMat.begin(), outputMat.end(), 0.0f);
+
+  auto cachePath = std::string("sycl_06_autotune_cache.txt");
+  std::remove(cachePath.c_str());
+
+  cl::sycl::queue defaultQueue;
+
+  size_t tile = 0;
+
+  {
+    cppcon::tracked_buffer<float, 1> inputMatBuf(inputMat.data(),
+                                                 inputMat.size());
+    cppcon::tracked_buffer<float, 1> outputMatBuf(outputMat.data(),
+                                                  outputMat.size());
+
+    int launches = 0;
+
+    auto launch = [&](cl::sycl::nd_range<2> ndRange) {
+      ++launches;
+      defaultQueue.submit([&](cl::sycl::handler& cgh) {
+        auto inputMatAcc =
+          inputMatBuf.template get_access<cl::sycl::access::mode::read>(cgh);
+        auto outputMatAcc =
+          outputMatBuf.template get_access<cl::sycl::access::mode::write>(
+            cgh);
+
+        auto scratchpad =
+          cl::sycl::accessor<float, 1, cl::sycl::access::mode::read_write,
+          cl::sycl::access::target::local>(
+            cl::sycl::range<1>(ndRange.get_local_range().size()), cgh);
+
+        cgh.parallel_for<tuned_local_mem>(
+          ndRange, [=](cl::sycl::nd_item<2> item) {
+            auto columnMajorId =
+              (item.get_global_id(1) * item.get_global_range(0)) +
+              item.get_global_id(0);
+
+            auto rowMajorLocalId =
+              (item.get_local_id(0) * item.get_local_range(1)) +
+              item.get_local_id(1);
+            auto columnMajorLocalId =
+              (item.get_local_id(1) * item.get_local_range(0)) +
+              item.get_local_id(0);
+
+            scratchpad[columnMajorLocalId] = inputMatAcc[columnMajorId];
+
+            item.barrier(cl::sycl::access::fence_space::global_and_local);
+
+            outputMatAcc[columnMajorId] = scratchpad[rowMajorLocalId];
+          });
+        });
+
+      defaultQueue.wait_and_throw();
+    };
+
+    /* The scratchpad transposes within a work-group, so only square
+     * work-groups are considered. */
+    std::function<bool(cl::sycl::range<2>)> square = [](cl::sycl::range<2> r) {
+      return r[0] == r[1];
+    };
+
+    auto tuned = cppcon::autotune_work_group_size(
+        defaultQueue, "tuned_local_mem", cl::sycl::range<2>(WIDTH, HEIGHT),
+        launch, sizeof(float), square, 10, cppcon::work_group_cache{cachePath});
+
+    std::cout << "Tuned work-group size: " << tuned[0] << "x" << tuned[1]
+              << "\n";
+
+    REQUIRE(launches > 0);
+    REQUIRE(tuned[0] == tuned[1]);
+
+    /* A second call must be served from the on-disk cache without launching
+     * the kernel again. */
+    launches = 0;
+    auto cached = cppcon::autotune_work_group_size(
+        defaultQueue, "tuned_local_mem", cl::sycl::range<2>(WIDTH, HEIGHT),
+        launch, sizeof(float), square, 10, cppcon::work_group_cache{cachePath});
+
+    REQUIRE(launches == 0);
+    REQUIRE(cached == tuned);
+
+    cppcon::benchmark(
+        [&]() { launch(cl::sycl::nd_range<2>(
+                    cl::sycl::range<2>(WIDTH, HEIGHT), tuned)); },
+        100, "tuned_local_mem");
+
+    tile = tuned[0];
+  }
+
+  /* The cache was written to disk, rather than only held in memory. */
+  REQUIRE(std::remove(cachePath.c_str()) == 0);
+
+  /* Each tile x tile block is transposed in place, whichever size won. */
+  for (size_t y = 0; y < HEIGHT; ++y) {
+    for (size_t x = 0; x < WIDTH; ++x) {
+      const size_t blockX = x - x % tile;
+      const size_t blockY = y - y % tile;
+      const size_t from = (blockY + x % tile) * WIDTH + blockX + y % tile;
+      REQUIRE(outputMat[y * WIDTH + x] == inputMat[from]);
+    }
+  }
+}
@@ -0,0 +1,109 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <half_storage.h>
+#include <host_baseline.h>
+
+#include <CL/sycl.hpp>
+
+static std::vector<float> make_matrix(size_t rows, size_t cols) {
+  std::vector<float> matrix(rows * cols);
+  for (size_t i = 0; i < matrix.size(); ++i) {
+    matrix[i] = static_cast<float>(i % 4099) * 0.25f;
+  }
+  return matrix;
+}
+
+template <typename Storage>
+static std::vector<float> device_transpose(cl::sycl::queue& queue,
+                                           const std::vector<float>& input,
+                                           size_t rows, size_t cols) {
+  auto inputData = cppcon::convert_storage<Storage>(input);
+  std::vector<Storage> outputData(input.size());
+  {
+    cl::sycl::buffer<Storage, 1> inputBuf(inputData.data(), inputData.size());
+    cl::sycl::buffer<Storage, 1> outputBuf(outputData.data(),
+                                           outputData.size());
+    cppcon::stored_transpose(queue, inputBuf, outputBuf, rows, cols);
+  }
+  return cppcon::convert_storage<float>(outputData);
+}
+
+TEST_CASE("half_transpose_accuracy", "sycl_06_matrix_transpose") {
+  /* Neither dimension is a multiple of the tile size. */
+  const size_t rows = 100;
+  const size_t cols = 61;
+
+  auto input = make_matrix(rows, cols);
+
+  cl::sycl::queue defaultQueue;
+
+  /* Moving data involves no arithmetic, so the only error is in converting
+   * the input to half, and the transposes of the stored values are exact. */
+  auto stored = cppcon::to_float(cppcon::to_half(input));
+  std::vector<float> expected(input.size());
+  cppcon::host::serial_transpose(input.data(), expected.data(), rows, cols);
+  std::vector<float> storedExpected(input.size());
+  cppcon::host::serial_transpose(stored.data(), storedExpected.data(), rows,
+                                 cols);
+
+  REQUIRE(cppcon::host::bit_equal(
+      device_transpose<float>(defaultQueue, input, rows, cols), expected));
+
+  cppcon::with_storage(
+      defaultQueue.get_device(), cppcon::storage_precision::half,
+      [&](auto storage) {
+        using Storage = decltype(storage);
+        auto result =
+            device_transpose<Storage>(defaultQueue, input, rows, cols);
+        REQUIRE(cppcon::max_relative_error(result, expected) <=
+                cppcon::half_epsilon / 2);
+        if (sizeof(Storage) == 2) {
+          REQUIRE(cppcon::host::bit_equal(result, storedExpected));
+        }
+        return 0;
+      });
+}
+
+TEST_CASE("half_transpose_throughput", "sycl_06_matrix_transpose") {
+  const size_t rows = 1024;
+  const size_t cols = 1024;
+  const int iterations = 20;
+
+  cl::sycl::queue defaultQueue;
+
+  auto input = make_matrix(rows, cols);
+
+  /* Each element is read and written once. */
+  cppcon::compare_storage_throughput(
+      defaultQueue,
+      "transpose storage (" + std::to_string(rows) + "x" +
+          std::to_string(cols) + ")",
+      2.0 * rows * cols, iterations, [&](auto storage, auto measure) {
+        using Storage = decltype(storage);
+
+        auto inputData = cppcon::convert_storage<Storage>(input);
+        std::vector<Storage> outputData(input.size());
+
+        cppcon::tracked_buffer<Storage, 1> inputBuf(inputData.data(),
+                                              inputData.size());
+        cppcon::tracked_buffer<Storage, 1> outputBuf(outputData.data(),
+                                               outputData.size());
+
+        measure([&]() {
+          cppcon::stored_transpose(defaultQueue, inputBuf, outputBuf, rows,
+                                   cols);
+        });
+      });
+}
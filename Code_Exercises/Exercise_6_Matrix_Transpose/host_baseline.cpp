@@ -0,0 +1,92 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <host_baseline.h>
+
+#include <numeric>
+
+#include <CL/sycl.hpp>
+
+class naive;
+
+static constexpr int WIDTH = 1024;
+static constexpr int HEIGHT = 1024;
+
+TEST_CASE("host_baseline_transpose", "sycl_06_matrix_transpose") {
+  std::vector<float> inputMat(WIDTH * HEIGHT);
+  std::vector<float> reference(WIDTH * HEIGHT);
+  std::vector<float> outputMat(WIDTH * HEIGHT);
+
+  std::iota(inputMat.begin(), inputMat.end(), 0.0f);
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("serial", cppcon::benchmark(
+    [&]() {
+      cppcon::host::serial_transpose(inputMat.data(), reference.data(), WIDTH,
+        HEIGHT);
+    },
+    100, "serial"));
+
+  std::fill(outputMat.begin(), outputMat.end(), 0.0f);
+  results.emplace_back("recursive", cppcon::benchmark(
+    [&]() {
+      cppcon::host::recursive_transpose(inputMat.data(), outputMat.data(),
+        WIDTH, HEIGHT);
+    },
+    100, "recursive"));
+  REQUIRE(cppcon::host::bit_equal(outputMat, reference));
+
+  std::fill(outputMat.begin(), outputMat.end(), 0.0f);
+
+  cl::sycl::queue defaultQueue;
+
+  {
+    cppcon::tracked_buffer<float, 1> inputMatBuf(inputMat.data(),
+                                                 inputMat.size());
+    cppcon::tracked_buffer<float, 1> outputMatBuf(outputMat.data(),
+                                                  outputMat.size());
+
+    results.emplace_back("sycl", cppcon::benchmark(
+      [&]() {
+        defaultQueue.submit([&](cl::sycl::handler& cgh) {
+          auto inputMatAcc =
+            inputMatBuf.template get_access<cl::sycl::access::mode::read>(
+              cgh);
+          auto outputMatAcc =
+            outputMatBuf.template get_access<cl::sycl::access::mode::write>(
+              cgh);
+
+          const auto width = WIDTH;
+          const auto height = HEIGHT;
+
+          cgh.parallel_for<naive>(
+            cl::sycl::range<2>(width, height),
+            [=](cl::sycl::id<2> idx) {
+              auto rowMajorId = (idx[1] * width) + idx[0];
+              auto columnMajorId = (idx[0] * height) + idx[1];
+
+              outputMatAcc[rowMajorId] = inputMatAcc[columnMajorId];
+            });
+          });
+
+        defaultQueue.wait_and_throw();
+      },
+      100, "sycl"));
+  }
+  REQUIRE(cppcon::host::bit_equal(outputMat, reference));
+
+  cppcon::print_comparison(results, "transpose (" + std::to_string(WIDTH) +
+    "x" + std::to_string(HEIGHT) + " floats)");
+}
@@ -0,0 +1,234 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define SYCL_ACADEMY_USING_COMPUTECPP
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+#include <SYCL/experimental/usm_wrapper.h>
+#include <CL/sycl.hpp>
+#include <SYCL/experimental.hpp>
+#define depends_on experimental_depends_on
+using namespace cl::sycl::experimental;
+#else  // SYCL_ACADEMY_USING_COMPUTECPP
+#include <CL/sycl.hpp>
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+#include <benchmark.h>
+#include <device_span.h>
+#include <usm_pool.h>
+
+#include <numeric>
+
+using namespace cl::sycl;
+
+struct usm_device_selector : public cl::sycl::device_selector {
+  int operator()(const cl::sycl::device& d) const override {
+    if (d.get_info<info::device::usm_device_allocations>()) {
+      return 1;
+    }
+    else {
+      return -1;
+    }
+  }
+};
+
+/* Large enough for a vec<float, 16>. */
+constexpr size_t alignment = 64;
+
+template <typename T>
+using span = cppcon::device_span<T, alignment>;
+
+template <typename T>
+class add_pointer;
+
+template <typename T>
+class add_span;
+
+template <typename T, int N>
+class add_vec;
+
+template <typename T, int N>
+class add_tail;
+
+/* As in the solution, capturing a usm_wrapper or a raw pointer. */
+template <typename T>
+event add_pointers(queue& usmQueue, T* inputAPtr, T* inputBPtr, T* outputPtr,
+  size_t size) {
+  return usmQueue.submit([&](handler &cgh) {
+    auto inAPtr = cppcon::make_usm_pointer(inputAPtr);
+    auto inBPtr = cppcon::make_usm_pointer(inputBPtr);
+    auto outPtr = cppcon::make_usm_pointer(outputPtr);
+
+    cgh.parallel_for<add_pointer<T>>(range<1>(size), [=](id<1> idx) {
+      auto index = idx[0];
+      outPtr[index] = inAPtr[index] + inBPtr[index];
+    });
+  });
+}
+
+/* The same kernel on either path, with no #ifdef. */
+template <typename T>
+event add_spans(queue& usmQueue, span<T> inA, span<T> inB, span<T> out) {
+  return usmQueue.submit([&](handler &cgh) {
+    cgh.parallel_for<add_span<T>>(range<1>(out.size()),
+      [=](id<1> idx) SYCL_ACADEMY_KERNEL_ARGS_RESTRICT {
+        auto index = idx[0];
+        out[index] = inA[index] + inB[index];
+      });
+  });
+}
+
+/* Each work-item adds a vec<T, N>, and any elements left over are added by a
+ * second kernel. */
+template <int N, typename T>
+event add_vecs(queue& usmQueue, span<T> inA, span<T> inB, span<T> out) {
+  const size_t vecCount = out.size() / N;
+  const size_t tailStart = vecCount * N;
+
+  auto vecs = usmQueue.submit([&](handler &cgh) {
+    cgh.parallel_for<add_vec<T, N>>(range<1>(vecCount),
+      [=](id<1> idx) SYCL_ACADEMY_KERNEL_ARGS_RESTRICT {
+        auto index = idx[0];
+        out.store(index, inA.template load<N>(index) +
+                         inB.template load<N>(index));
+      });
+  });
+
+  if (tailStart == out.size()) {
+    return vecs;
+  }
+
+  return usmQueue.submit([&](handler &cgh) {
+    cgh.parallel_for<add_tail<T, N>>(range<1>(out.size() - tailStart),
+      [=](id<1> idx) SYCL_ACADEMY_KERNEL_ARGS_RESTRICT {
+        auto index = tailStart + idx[0];
+        out[index] = inA[index] + inB[index];
+      });
+  });
+}
+
+struct device_vectors {
+  device_vectors(queue& usmQueue, size_t size)
+    : usmQueue{usmQueue}, size{size}, alloc{usmQueue},
+      inputAPtr{alloc.allocate(size)},
+      inputBPtr{alloc.allocate(size)},
+      outputPtr{alloc.allocate(size)} {
+    std::vector<float> input(size);
+    std::iota(input.begin(), input.end(), 0.0f);
+
+    usmQueue.memcpy(inputAPtr, input.data(), size * sizeof(float)).wait();
+    usmQueue.memcpy(inputBPtr, input.data(), size * sizeof(float)).wait();
+  }
+
+  ~device_vectors() {
+    alloc.deallocate(inputAPtr, size);
+    alloc.deallocate(inputBPtr, size);
+    alloc.deallocate(outputPtr, size);
+  }
+
+  span<float> inA() { return span<float>{inputAPtr, size}; }
+  span<float> inB() { return span<float>{inputBPtr, size}; }
+  span<float> out() { return span<float>{outputPtr, size}; }
+
+  std::vector<float> result() {
+    std::vector<float> output(size);
+    usmQueue.memcpy(output.data(), outputPtr, size * sizeof(float)).wait();
+    return output;
+  }
+
+  queue& usmQueue;
+  size_t size;
+  /* Tracked, so the benchmarks report the USM footprint. */
+  cppcon::tracking_usm_allocator<float> alloc;
+  float* inputAPtr;
+  float* inputBPtr;
+  float* outputPtr;
+};
+
+static bool check(const std::vector<float>& output) {
+  for (size_t i = 0; i < output.size(); i++) {
+    if (output[i] != static_cast<float>(i * 2.0f)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST_CASE("device_span_add", "sycl_07_unified_shared_memory_ext") {
+  /* Not a multiple of any of the vector widths, to exercise the tail. */
+  const size_t size = 1000 + 7;
+
+  auto usmQueue = queue{usm_device_selector{}};
+  device_vectors v{usmQueue, size};
+
+  REQUIRE(v.out().size() == size);
+  REQUIRE_THROWS_AS(span<float>(v.outputPtr + 1, size - 1),
+                    std::invalid_argument);
+
+  add_pointers(usmQueue, v.inputAPtr, v.inputBPtr, v.outputPtr, size).wait();
+  REQUIRE(check(v.result()));
+
+  add_spans(usmQueue, v.inA(), v.inB(), v.out()).wait();
+  REQUIRE(check(v.result()));
+
+  add_vecs<4>(usmQueue, v.inA(), v.inB(), v.out()).wait();
+  REQUIRE(check(v.result()));
+
+  add_vecs<16>(usmQueue, v.inA(), v.inB(), v.out()).wait();
+  REQUIRE(check(v.result()));
+}
+
+TEST_CASE("device_span_vector_width", "sycl_07_unified_shared_memory_ext") {
+  const size_t size = 1 << 24;
+
+  auto usmQueue = queue{usm_device_selector{}};
+  device_vectors v{usmQueue, size};
+
+  /* The widths the device reports, to compare with the fastest width below. */
+  auto dev = usmQueue.get_device();
+  std::cout << dev.get_info<info::device::name>() << ": preferred float width "
+            << dev.get_info<info::device::preferred_vector_width_float>()
+            << ", native float width "
+            << dev.get_info<info::device::native_vector_width_float>()
+            << "\n\n";
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("pointer", cppcon::benchmark(
+    [&]() {
+      add_pointers(usmQueue, v.inputAPtr, v.inputBPtr, v.outputPtr, size)
+        .wait();
+    },
+    100, "pointer"));
+
+  results.emplace_back("device_span", cppcon::benchmark(
+    [&]() { add_spans(usmQueue, v.inA(), v.inB(), v.out()).wait(); }, 100,
+    "device_span"));
+
+  results.emplace_back("device_span vec<float, 4>", cppcon::benchmark(
+    [&]() { add_vecs<4>(usmQueue, v.inA(), v.inB(), v.out()).wait(); }, 100,
+    "device_span vec<float, 4>"));
+
+  results.emplace_back("device_span vec<float, 8>", cppcon::benchmark(
+    [&]() { add_vecs<8>(usmQueue, v.inA(), v.inB(), v.out()).wait(); }, 100,
+    "device_span vec<float, 8>"));
+
+  results.emplace_back("device_span vec<float, 16>", cppcon::benchmark(
+    [&]() { add_vecs<16>(usmQueue, v.inA(), v.inB(), v.out()).wait(); }, 100,
+    "device_span vec<float, 16>"));
+
+  REQUIRE(check(v.result()));
+
+  cppcon::print_comparison(results, "vector add (" + std::to_string(size) +
+    " floats)");
+}
@@ -0,0 +1,330 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define SYCL_ACADEMY_USING_COMPUTECPP
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+#include <SYCL/experimental/usm_wrapper.h>
+#include <CL/sycl.hpp>
+#include <SYCL/experimental.hpp>
+#define depends_on experimental_depends_on
+using namespace cl::sycl::experimental;
+#else  // SYCL_ACADEMY_USING_COMPUTECPP
+#include <CL/sycl.hpp>
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+#include <benchmark.h>
+#include <host_baseline.h>
+#include <usm_pointer.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <numeric>
+#include <utility>
+
+/* Measures the fixed costs of submitting work, which dominate for kernels as
+ * small as those in the exercises, and the problem size above which
+ * offloading a vector add to the device pays off. Times are per launch. */
+
+using namespace cl::sycl;
+
+struct usm_device_selector : public cl::sycl::device_selector {
+  int operator()(const cl::sycl::device& d) const override {
+    if (d.get_info<info::device::usm_device_allocations>()) {
+      return 1;
+    }
+    else {
+      return -1;
+    }
+  }
+};
+
+constexpr int iterations = 1000;
+
+struct queue_config {
+  std::string name;
+  queue q;
+};
+
+static std::vector<queue_config> make_queues() {
+  auto dev = queue{usm_device_selector{}}.get_device();
+  return {{"out-of-order", queue{dev}},
+          {"in-order", queue{dev, property_list{property::queue::in_order{}}}}};
+}
+
+class empty_single_task;
+class empty_parallel_for;
+class throughput_kernel;
+class usm_kernel;
+class buffer_kernel;
+class dependent_kernel;
+class dependency_kernel;
+
+template <int N>
+class accessor_kernel;
+
+template <typename T>
+class offload_add;
+
+TEST_CASE("empty_kernel_latency", "sycl_07_unified_shared_memory_ext") {
+  for (auto& config : make_queues()) {
+    auto& q = config.q;
+    std::vector<cppcon::benchmark_result> results;
+
+    auto singleTask = [&]() {
+      return q.submit([&](handler& cgh) {
+        cgh.single_task<empty_single_task>([=]() {});
+      });
+    };
+
+    results.emplace_back("single_task, wait", cppcon::benchmark(
+      [&]() { singleTask().wait(); }, iterations, "single_task, wait"));
+
+    results.emplace_back("parallel_for, wait", cppcon::benchmark(
+      [&]() {
+        q.submit([&](handler& cgh) {
+          cgh.parallel_for<empty_parallel_for>(range<1>(1), [=](id<1>) {});
+        }).wait();
+      },
+      iterations, "parallel_for, wait"));
+
+    results.emplace_back("single_task, wait_and_throw", cppcon::benchmark(
+      [&]() { singleTask().wait_and_throw(); }, iterations,
+      "single_task, wait_and_throw"));
+
+    cppcon::print_comparison(results, "empty kernel latency, " + config.name +
+      " queue (ms per launch)");
+  }
+}
+
+TEST_CASE("submit_throughput", "sycl_07_unified_shared_memory_ext") {
+  const int batch = 1000;
+
+  for (auto& config : make_queues()) {
+    auto& q = config.q;
+
+    auto time = cppcon::benchmark(
+      [&]() {
+        for (int k = 0; k < batch; ++k) {
+          q.submit([&](handler& cgh) {
+            cgh.single_task<throughput_kernel>([=]() {});
+          });
+        }
+        q.wait_and_throw();
+      },
+      10, config.name + " queue, " + std::to_string(batch) + " kernels");
+
+    std::cout << config.name << " queue: " << (batch * 1000.0) / time.count()
+              << " kernels/s\n\n";
+  }
+}
+
+template <int N, typename... Accessors>
+void touch_accessors(handler& cgh, Accessors... accessors) {
+  static_assert(sizeof...(Accessors) == N, "one accessor per buffer");
+  cgh.single_task<accessor_kernel<N>>([=]() {
+    ((accessors[0] += 1.0f), ...);
+  });
+}
+
+template <int N, size_t... Is>
+event submit_accessors(queue& q, std::vector<buffer<float, 1>>& buffers,
+  std::index_sequence<Is...>) {
+  return q.submit([&](handler& cgh) {
+    touch_accessors<N>(cgh,
+      buffers[Is].get_access<access::mode::read_write>(cgh)...);
+  });
+}
+
+template <int N>
+cppcon::benchmark_result accessor_latency(queue& q) {
+  std::vector<buffer<float, 1>> buffers;
+  for (int b = 0; b < N; ++b) {
+    buffers.emplace_back(range<1>(1));
+  }
+  auto name = std::to_string(N) + " accessor(s)";
+  return {name, cppcon::benchmark(
+    [&]() {
+      submit_accessors<N>(q, buffers, std::make_index_sequence<N>{}).wait();
+    },
+    iterations, name)};
+}
+
+TEST_CASE("accessor_count_latency", "sycl_07_unified_shared_memory_ext") {
+  for (auto& config : make_queues()) {
+    std::vector<cppcon::benchmark_result> results;
+
+    results.push_back(accessor_latency<1>(config.q));
+    results.push_back(accessor_latency<2>(config.q));
+    results.push_back(accessor_latency<4>(config.q));
+    results.push_back(accessor_latency<8>(config.q));
+
+    cppcon::print_comparison(results, "accessor count, " + config.name +
+      " queue (ms per launch)");
+  }
+}
+
+TEST_CASE("dependency_count_latency", "sycl_07_unified_shared_memory_ext") {
+  for (auto& config : make_queues()) {
+    auto& q = config.q;
+    std::vector<cppcon::benchmark_result> results;
+
+    for (int count : {0, 1, 4, 16}) {
+      /* The dependencies have already completed, so this measures only the
+       * cost of tracking them. */
+      std::vector<event> dependencies;
+      for (int d = 0; d < count; ++d) {
+        dependencies.push_back(q.submit([&](handler& cgh) {
+          cgh.single_task<dependency_kernel>([=]() {});
+        }));
+      }
+      q.wait_and_throw();
+
+      auto name = std::to_string(count) + " dependencies";
+      results.emplace_back(name, cppcon::benchmark(
+        [&]() {
+          q.submit([&](handler& cgh) {
+            for (auto& dependency : dependencies) {
+              cgh.depends_on(dependency);
+            }
+            cgh.single_task<dependent_kernel>([=]() {});
+          }).wait();
+        },
+        iterations, name));
+    }
+
+    cppcon::print_comparison(results, "dependency count, " + config.name +
+      " queue (ms per launch)");
+  }
+}
+
+TEST_CASE("buffer_vs_usm_latency", "sycl_07_unified_shared_memory_ext") {
+  for (auto& config : make_queues()) {
+    auto& q = config.q;
+    std::vector<cppcon::benchmark_result> results;
+
+    buffer<float, 1> buf{range<1>(1)};
+    auto ptr = malloc_device<float>(1, q);
+
+    results.emplace_back("buffer accessor", cppcon::benchmark(
+      [&]() {
+        q.submit([&](handler& cgh) {
+          auto acc = buf.get_access<access::mode::read_write>(cgh);
+          cgh.single_task<buffer_kernel>([=]() { acc[0] += 1.0f; });
+        }).wait();
+      },
+      iterations, "buffer accessor"));
+
+    results.emplace_back("USM pointer", cppcon::benchmark(
+      [&]() {
+        q.submit([&](handler& cgh) {
+          auto usmPtr = cppcon::make_usm_pointer(ptr);
+          cgh.single_task<usm_kernel>([=]() { usmPtr[0] += 1.0f; });
+        }).wait();
+      },
+      iterations, "USM pointer"));
+
+    free(ptr, q);
+
+    cppcon::print_comparison(results, "buffer vs USM, " + config.name +
+      " queue (ms per launch)");
+  }
+}
+
+/* Sweeps the size of a vector add to find where the device, with the data
+ * already resident and including copies to and from the host, overtakes a
+ * serial loop on the host. */
+TEST_CASE("offload_break_even", "sycl_07_unified_shared_memory_ext") {
+  auto q = queue{usm_device_selector{}};
+
+  size_t residentBreakEven = 0;
+  size_t copiedBreakEven = 0;
+
+  std::cout << std::setw(10) << "floats" << std::setw(14) << "host ms"
+            << std::setw(14) << "resident ms" << std::setw(14) << "copied ms"
+            << "\n";
+
+  for (size_t size = 1 << 6; size <= (1 << 22); size *= 4) {
+    std::vector<float> inputA(size, 1.0f);
+    std::vector<float> inputB(size, 2.0f);
+    std::vector<float> output(size);
+
+    auto inputAPtr = malloc_device<float>(size, q);
+    auto inputBPtr = malloc_device<float>(size, q);
+    auto outputPtr = malloc_device<float>(size, q);
+
+    q.memcpy(inputAPtr, inputA.data(), size * sizeof(float)).wait();
+    q.memcpy(inputBPtr, inputB.data(), size * sizeof(float)).wait();
+
+    auto add = [&]() {
+      return q.submit([&](handler& cgh) {
+        auto inAPtr = cppcon::make_usm_pointer(inputAPtr);
+        auto inBPtr = cppcon::make_usm_pointer(inputBPtr);
+        auto outPtr = cppcon::make_usm_pointer(outputPtr);
+        cgh.parallel_for<offload_add<float>>(range<1>(size), [=](id<1> idx) {
+          auto index = idx[0];
+          outPtr[index] = inAPtr[index] + inBPtr[index];
+        });
+      });
+    };
+
+    const int reps = static_cast<int>(std::max<size_t>(10, (1 << 20) / size));
+    auto caption = std::to_string(size) + " floats";
+
+    auto host = cppcon::benchmark(
+      [&]() { cppcon::host::serial_add(inputA, inputB, output); }, reps,
+      "host, " + caption);
+
+    auto resident = cppcon::benchmark([&]() { add().wait(); }, reps,
+      "resident, " + caption);
+
+    auto copied = cppcon::benchmark(
+      [&]() {
+        auto copyA = q.memcpy(inputAPtr, inputA.data(), size * sizeof(float));
+        auto copyB = q.memcpy(inputBPtr, inputB.data(), size * sizeof(float));
+        copyA.wait();
+        copyB.wait();
+        add().wait();
+        q.memcpy(output.data(), outputPtr, size * sizeof(float)).wait();
+      },
+      reps, "copied, " + caption);
+
+    REQUIRE(output[size - 1] == 3.0f);
+
+    free(inputAPtr, q);
+    free(inputBPtr, q);
+    free(outputPtr, q);
+
+    std::cout << std::setw(10) << size << std::setw(14) << host.count()
+              << std::setw(14) << resident.count() << std::setw(14)
+              << copied.count() << "\n\n";
+
+    if (!residentBreakEven && resident < host) {
+      residentBreakEven = size;
+    }
+    if (!copiedBreakEven && copied < host) {
+      copiedBreakEven = size;
+    }
+  }
+
+  auto report = [](std::string what, size_t size) {
+    std::cout << "Offloading " << what << " pays off from ";
+    if (size) {
+      std::cout << size << " floats\n";
+    } else {
+      std::cout << "none of the sizes measured\n";
+    }
+  };
+  report("with resident data", residentBreakEven);
+  report("including copies", copiedBreakEven);
+}
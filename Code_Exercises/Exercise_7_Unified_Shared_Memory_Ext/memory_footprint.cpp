@@ -0,0 +1,227 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define SYCL_ACADEMY_USING_COMPUTECPP
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+#include <SYCL/experimental/usm_wrapper.h>
+#include <CL/sycl.hpp>
+#include <SYCL/experimental.hpp>
+#define depends_on experimental_depends_on
+using namespace cl::sycl::experimental;
+#else  // SYCL_ACADEMY_USING_COMPUTECPP
+#include <CL/sycl.hpp>
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+#include <benchmark.h>
+#include <memory_footprint.h>
+#include <usm_pointer.h>
+#include <usm_pool.h>
+
+#include <numeric>
+
+using namespace cl::sycl;
+
+struct usm_device_selector : public cl::sycl::device_selector {
+  int operator()(const cl::sycl::device& d) const override {
+    if (d.get_info<info::device::usm_device_allocations>()) {
+      return 1;
+    }
+    else {
+      return -1;
+    }
+  }
+};
+
+template <typename T>
+class add_tracked;
+
+TEST_CASE("tracking_usm_allocator", "sycl_07_unified_shared_memory_ext") {
+  auto usmQueue = queue{usm_device_selector{}};
+  auto& tracker = cppcon::memory_tracker::instance();
+  const auto before = tracker.current();
+
+  cppcon::tracking_usm_allocator<float> deviceAlloc{usmQueue};
+  auto ptr = deviceAlloc.allocate(1024);
+  REQUIRE(tracker.current(cppcon::memory_kind::usm_device) ==
+          1024 * sizeof(float));
+
+  {
+    cppcon::tracking_usm_allocator<float> sharedAlloc{usmQueue,
+                                                      cppcon::usm_kind::shared};
+    std::vector<float, cppcon::tracking_usm_allocator<float>> values(
+        256, 1.0f, sharedAlloc);
+    REQUIRE(tracker.current(cppcon::memory_kind::usm_shared) >=
+            256 * sizeof(float));
+    REQUIRE(std::accumulate(values.begin(), values.end(), 0.0f) == 256.0f);
+  }
+  REQUIRE(tracker.current(cppcon::memory_kind::usm_shared) == 0);
+
+  deviceAlloc.deallocate(ptr, 1024);
+  REQUIRE(tracker.current() == before);
+  REQUIRE(tracker.peak() >= before + 1024 * sizeof(float));
+}
+
+TEST_CASE("tracked_pool_and_buffers", "sycl_07_unified_shared_memory_ext") {
+  auto usmQueue = queue{usm_device_selector{}};
+  auto& tracker = cppcon::memory_tracker::instance();
+  const auto before = tracker.current();
+
+  {
+    cppcon::usm_pool pool{usmQueue};
+    auto block = pool.make_unique<float>(1000);
+
+    /* The pool's reserved blocks count, in use or cached. */
+    REQUIRE(tracker.current(cppcon::memory_kind::usm_device) ==
+            pool.stats().bytesReserved);
+    block.reset();
+    REQUIRE(tracker.current(cppcon::memory_kind::usm_device) ==
+            pool.stats().bytesReserved);
+    pool.trim();
+    REQUIRE(tracker.current(cppcon::memory_kind::usm_device) == 0);
+  }
+
+  {
+    buffer<float, 1> buf{range<1>(4096)};
+    auto tracked = cppcon::track_buffer(buf);
+    REQUIRE(tracker.current(cppcon::memory_kind::buffer) ==
+            4096 * sizeof(float));
+  }
+
+  {
+    /* A tracked_buffer counts once however many copies there are. */
+    cppcon::tracked_buffer<float, 1> buf{range<1>(4096)};
+    auto copy = buf;
+    REQUIRE(tracker.current(cppcon::memory_kind::buffer) ==
+            4096 * sizeof(float));
+  }
+  REQUIRE(tracker.current() == before);
+}
+
+TEST_CASE("benchmark_footprint", "sycl_07_unified_shared_memory_ext") {
+  auto usmQueue = queue{usm_device_selector{}};
+  cppcon::tracking_usm_allocator<float> alloc{usmQueue};
+
+  const size_t size = 1 << 20;
+
+  /* Allocates and frees a block per iteration: a peak, but nothing held. */
+  cppcon::benchmark(
+    [&]() { alloc.deallocate(alloc.allocate(size), size); }, 4, "balanced");
+  REQUIRE(cppcon::last_footprint().peakTracked >= size * sizeof(float));
+  REQUIRE(cppcon::last_footprint().retained() == 0);
+
+  /* Leaks a block per iteration, as a missing free would. */
+  std::vector<float*> leaked;
+  cppcon::benchmark(
+    [&]() { leaked.push_back(alloc.allocate(size)); }, 4, "leaking");
+  REQUIRE(cppcon::last_footprint().retained() == 4 * size * sizeof(float));
+
+  for (auto ptr : leaked) {
+    alloc.deallocate(ptr, size);
+  }
+
+  /* A host allocation shows up in the resident set. */
+  cppcon::benchmark(
+    [&]() {
+      std::vector<char> host(64 << 20, 1);
+      REQUIRE(host.back() == 1);
+    },
+    1, "host");
+  const auto& footprint = cppcon::last_footprint();
+  REQUIRE(footprint.peakRss >= footprint.steadyRss);
+  if (footprint.peakRssReset) {
+    REQUIRE(footprint.peakRss >= static_cast<size_t>(64 << 20));
+  }
+}
+
+/* The device memory for a vector add allocated per call, or kept in a pool,
+ * as in usm_pool, and the footprint each holds once it returns. */
+template <typename T, typename Alloc>
+void parallel_add(queue& usmQueue, Alloc&& allocate, std::vector<T>& inputA,
+  std::vector<T>& inputB, std::vector<T>& output) {
+  const auto size = inputA.size();
+  const auto sizeInBytes = size * sizeof(T);
+
+  auto inputAPtr = allocate(size);
+  auto inputBPtr = allocate(size);
+  auto outputPtr = allocate(size);
+
+  auto copyInputA = usmQueue.memcpy(inputAPtr.get(), inputA.data(),
+    sizeInBytes);
+  auto copyInputB = usmQueue.memcpy(inputBPtr.get(), inputB.data(),
+    sizeInBytes);
+
+  usmQueue.submit([&](handler &cgh) {
+    cgh.depends_on(copyInputA);
+    cgh.depends_on(copyInputB);
+
+    auto inAPtr = cppcon::make_usm_pointer(inputAPtr.get());
+    auto inBPtr = cppcon::make_usm_pointer(inputBPtr.get());
+    auto outPtr = cppcon::make_usm_pointer(outputPtr.get());
+
+    cgh.parallel_for<add_tracked<T>>(range<1>(size), [=](id<1> idx) {
+      auto index = idx[0];
+      outPtr[index] = inAPtr[index] + inBPtr[index];
+    });
+  }).wait();
+
+  usmQueue.memcpy(output.data(), outputPtr.get(), sizeInBytes).wait();
+}
+
+TEST_CASE("usm_footprint", "sycl_07_unified_shared_memory_ext") {
+  const size_t size = 1 << 20;
+  const int iterations = 20;
+
+  auto usmQueue = queue{usm_device_selector{}};
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  std::vector<cppcon::benchmark_result> results;
+
+  cppcon::tracking_usm_allocator<float> alloc{usmQueue};
+  auto allocatePerCall = [&](size_t count) {
+    auto deleter = [&, count](float* ptr) { alloc.deallocate(ptr, count); };
+    return std::unique_ptr<float, decltype(deleter)>{alloc.allocate(count),
+                                                      deleter};
+  };
+
+  results.emplace_back("malloc per call", cppcon::benchmark(
+    [&]() {
+      parallel_add(usmQueue, allocatePerCall, inputA, inputB, output);
+    },
+    iterations, "malloc per call"));
+  REQUIRE(results.back().memory.retained() == 0);
+
+  cppcon::usm_pool pool{usmQueue};
+  auto allocatePooled = [&](size_t count) {
+    return pool.make_unique<float>(count);
+  };
+
+  results.emplace_back("usm_pool", cppcon::benchmark(
+    [&]() {
+      parallel_add(usmQueue, allocatePooled, inputA, inputB, output);
+    },
+    iterations, "usm_pool"));
+  /* The pool keeps its blocks cached between calls. */
+  REQUIRE(results.back().memory.retained() == pool.stats().bytesReserved);
+
+  REQUIRE(output[size - 1] == static_cast<float>((size - 1) * 2));
+
+  cppcon::print_comparison(results, "vector add device memory (" +
+    std::to_string(size) + " floats)");
+}
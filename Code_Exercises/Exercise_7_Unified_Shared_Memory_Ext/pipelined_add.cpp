@@ -0,0 +1,187 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define SYCL_ACADEMY_USING_COMPUTECPP
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+#include <SYCL/experimental/usm_wrapper.h>
+#include <CL/sycl.hpp>
+#include <SYCL/experimental.hpp>
+#define depends_on experimental_depends_on
+using namespace cl::sycl::experimental;
+#else  // SYCL_ACADEMY_USING_COMPUTECPP
+#include <CL/sycl.hpp>
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+#include <benchmark.h>
+#include <usm_pool.h>
+
+#include <algorithm>
+#include <numeric>
+
+using namespace cl::sycl;
+
+struct usm_device_selector : public cl::sycl::device_selector {
+  int operator()(const cl::sycl::device& d) const override {
+    if (d.get_info<info::device::usm_device_allocations>()) {
+      return 1;
+    }
+    else {
+      return -1;
+    }
+  }
+};
+
+template <typename T>
+class add_chunk;
+
+/* Splits the vectors into chunks and gives each chunk its own copy-in, kernel
+ * and copy-out, chained only by that chunk's events. With no dependencies
+ * between chunks, the runtime is free to copy in one chunk while computing
+ * another and copying out a third.
+ *
+ * Chunk c is submitted to queues[c % queues.size()]. Pass a single
+ * out-of-order queue, or several in-order queues sharing a context, so that
+ * the commands of different chunks can run concurrently. The queues must
+ * share a context with the pool's queue. For copies to overlap with compute
+ * on a discrete device the host memory generally needs to be pinned, for
+ * example allocated with malloc_host. */
+template <typename T>
+void parallel_add_pipelined(std::vector<queue>& queues, cppcon::usm_pool& pool,
+  const T* inputA, const T* inputB, T* output, size_t size, size_t chunks) {
+  chunks = std::max<size_t>(1, std::min(chunks, size));
+
+  auto inputAPtr = pool.make_unique<T>(size);
+  auto inputBPtr = pool.make_unique<T>(size);
+  auto outputPtr = pool.make_unique<T>(size);
+
+  std::vector<event> copiesOut;
+
+  for (size_t c = 0; c < chunks; ++c) {
+    auto& chunkQueue = queues[c % queues.size()];
+
+    const size_t offset = (size * c) / chunks;
+    const size_t count = (size * (c + 1)) / chunks - offset;
+    const size_t countInBytes = count * sizeof(T);
+
+    auto copyInputA = chunkQueue.memcpy(inputAPtr.get() + offset,
+      inputA + offset, countInBytes);
+    auto copyInputB = chunkQueue.memcpy(inputBPtr.get() + offset,
+      inputB + offset, countInBytes);
+
+    auto compute = chunkQueue.submit([&](handler &cgh) {
+      cgh.depends_on(copyInputA);
+      cgh.depends_on(copyInputB);
+
+      auto inAPtr = cppcon::make_usm_pointer(inputAPtr.get());
+      auto inBPtr = cppcon::make_usm_pointer(inputBPtr.get());
+      auto outPtr = cppcon::make_usm_pointer(outputPtr.get());
+
+      cgh.parallel_for<add_chunk<T>>(range<1>(count), [=](id<1> idx) {
+        auto index = offset + idx[0];
+        outPtr[index] = inAPtr[index] + inBPtr[index];
+      });
+    });
+
+    copiesOut.push_back(chunkQueue.submit([&](handler &cgh) {
+      cgh.depends_on(compute);
+      cgh.memcpy(output + offset, outputPtr.get() + offset, countInBytes);
+    }));
+  }
+
+  for (auto& copyOut : copiesOut) {
+    copyOut.wait_and_throw();
+  }
+}
+
+/* Several in-order queues sharing the context and device of usmQueue. */
+static std::vector<queue> in_order_queues(queue& usmQueue, size_t count) {
+  std::vector<queue> queues;
+  for (size_t q = 0; q < count; ++q) {
+    queues.emplace_back(usmQueue.get_context(), usmQueue.get_device(),
+      property_list{property::queue::in_order{}});
+  }
+  return queues;
+}
+
+TEST_CASE("pipelined_add", "sycl_07_unified_shared_memory_ext") {
+  const int size = 100003;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  auto usmQueue = queue{usm_device_selector{}};
+  cppcon::usm_pool pool{usmQueue};
+
+  std::vector<std::vector<queue>> modes = {
+    {usmQueue}, in_order_queues(usmQueue, 3)};
+
+  for (auto& queues : modes) {
+    for (size_t chunks : {1, 2, 7, 64}) {
+      std::fill(begin(output), end(output), 0.0f);
+
+      parallel_add_pipelined(queues, pool, inputA.data(), inputB.data(),
+        output.data(), size, chunks);
+
+      for (int i = 0; i < size; i++) {
+        REQUIRE(output[i] == static_cast<float>(i * 2.0f));
+      }
+    }
+  }
+}
+
+TEST_CASE("pipelined_add_throughput", "sycl_07_unified_shared_memory_ext") {
+  const size_t size = 1 << 24;
+  const size_t chunkCounts[] = {1, 2, 4, 8, 16, 32};
+
+  std::vector<float> inputA(size, 1.0f);
+  std::vector<float> inputB(size, 2.0f);
+  std::vector<float> output(size);
+
+  auto usmQueue = queue{usm_device_selector{}};
+  cppcon::usm_pool pool{usmQueue};
+
+  std::vector<std::pair<std::string, std::vector<queue>>> modes = {
+    {"out-of-order queue", {usmQueue}},
+    {"3 in-order queues", in_order_queues(usmQueue, 3)}};
+
+  for (auto& mode : modes) {
+    std::vector<cppcon::benchmark_result> results;
+
+    for (auto chunks : chunkCounts) {
+      auto caption = mode.first + ", K = " + std::to_string(chunks);
+      results.emplace_back(caption, cppcon::benchmark(
+        [&]() {
+          parallel_add_pipelined(mode.second, pool, inputA.data(),
+            inputB.data(), output.data(), size, chunks);
+        },
+        10, caption));
+
+      REQUIRE(output[size - 1] == 3.0f);
+    }
+
+    /* Two copies in and one copy out per element. */
+    for (const auto& result : results) {
+      std::cout << result.name << ": "
+                << (3 * size * sizeof(float)) / (result.time.count() * 1e6)
+                << "GB/s\n";
+    }
+
+    cppcon::print_comparison(results, "pipelined add, " + mode.first + " (" +
+      std::to_string(size) + " floats)");
+  }
+}
@@ -0,0 +1,81 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define SYCL_ACADEMY_USING_COMPUTECPP
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+#include <SYCL/experimental/usm_wrapper.h>
+#include <CL/sycl.hpp>
+#include <SYCL/experimental.hpp>
+using namespace cl::sycl::experimental;
+#else  // SYCL_ACADEMY_USING_COMPUTECPP
+#include <CL/sycl.hpp>
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+#include <reduce_scan.h>
+
+#include <functional>
+#include <numeric>
+
+using namespace cl::sycl;
+
+struct usm_device_selector : public cl::sycl::device_selector {
+  int operator()(const cl::sycl::device& d) const override {
+    if (d.get_info<info::device::usm_device_allocations>()) {
+      return 1;
+    }
+    else {
+      return -1;
+    }
+  }
+};
+
+TEST_CASE("reduce_scan_usm", "sycl_07_unified_shared_memory_ext") {
+  const size_t size = 100000;
+
+  std::vector<int> input(size);
+  std::vector<int> inclusive(size);
+  std::vector<int> exclusive(size);
+  std::vector<int> expected(size);
+
+  for (size_t i = 0; i < size; ++i) {
+    input[i] = static_cast<int>(i % 97);
+  }
+
+  auto usmQueue = queue{ usm_device_selector{} };
+
+  auto inputPtr = malloc_device<int>(size, usmQueue);
+  auto outputPtr = malloc_device<int>(size, usmQueue);
+
+  usmQueue.memcpy(inputPtr, input.data(), size * sizeof(int)).wait();
+
+  REQUIRE(cppcon::reduce(usmQueue, inputPtr, size, 0, std::plus<int>{}) ==
+          std::reduce(input.begin(), input.end(), 0));
+
+  cppcon::inclusive_scan(usmQueue, inputPtr, size, outputPtr,
+                         std::plus<int>{});
+  usmQueue.memcpy(inclusive.data(), outputPtr, size * sizeof(int)).wait();
+
+  std::inclusive_scan(input.begin(), input.end(), expected.begin());
+  REQUIRE(inclusive == expected);
+
+  cppcon::exclusive_scan(usmQueue, inputPtr, size, outputPtr, 0,
+                         std::plus<int>{});
+  usmQueue.memcpy(exclusive.data(), outputPtr, size * sizeof(int)).wait();
+
+  std::exclusive_scan(input.begin(), input.end(), expected.begin(), 0);
+  REQUIRE(exclusive == expected);
+
+  free(inputPtr, usmQueue);
+  free(outputPtr, usmQueue);
+}
@@ -83,6 +83,10 @@ void parallel_add(std::vector<T>& inputA, std::vector<T>& inputB,
   }).wait();
 
   usmQueue.memcpy(output.data(), outputPtr, sizeInBytes).wait();
+
+  free(inputAPtr, usmQueue);
+  free(inputBPtr, usmQueue);
+  free(outputPtr, usmQueue);
 }
 
 TEST_CASE("parallel_for_usm", "sycl_07_unified_shared_memory_ext") {
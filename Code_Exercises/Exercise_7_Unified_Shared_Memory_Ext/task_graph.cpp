@@ -0,0 +1,292 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define SYCL_ACADEMY_USING_COMPUTECPP
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+#include <SYCL/experimental/usm_wrapper.h>
+#include <CL/sycl.hpp>
+#include <SYCL/experimental.hpp>
+#define depends_on experimental_depends_on
+using namespace cl::sycl::experimental;
+#else  // SYCL_ACADEMY_USING_COMPUTECPP
+#include <CL/sycl.hpp>
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+#include <benchmark.h>
+#include <task_graph.h>
+#include <usm_pointer.h>
+
+#include <numeric>
+
+using namespace cl::sycl;
+
+struct usm_device_selector : public cl::sycl::device_selector {
+  int operator()(const cl::sycl::device& d) const override {
+    if (d.get_info<info::device::usm_device_allocations>()) {
+      return 1;
+    }
+    else {
+      return -1;
+    }
+  }
+};
+
+template <typename Name>
+class add;
+
+class add_x;
+class add_y;
+class add_z;
+
+/* The command group function for out = inA + inB, for use with submit or as
+ * a task graph node. */
+template <typename Name, typename T>
+std::function<void(handler&)> add_cgf(const T* inputAPtr, const T* inputBPtr,
+  T* outputPtr, size_t size) {
+  return [=](handler& cgh) {
+    auto inAPtr = cppcon::make_usm_pointer(const_cast<T*>(inputAPtr));
+    auto inBPtr = cppcon::make_usm_pointer(const_cast<T*>(inputBPtr));
+    auto outPtr = cppcon::make_usm_pointer(outputPtr);
+
+    cgh.parallel_for<add<Name>>(range<1>(size), [=](id<1> idx) {
+      auto index = idx[0];
+      outPtr[index] = inAPtr[index] + inBPtr[index];
+    });
+  };
+}
+
+/* Device memory for z = (a + b) + (b + c), where x = a + b and y = b + c can
+ * run concurrently once their inputs have been copied. */
+struct workload {
+  workload(queue& usmQueue, size_t size)
+    : usmQueue{usmQueue}, size{size}, a(size), b(size), c(size), z(size) {
+    std::iota(a.begin(), a.end(), 0.0f);
+    std::fill(b.begin(), b.end(), 1.0f);
+    std::iota(c.begin(), c.end(), 0.0f);
+
+    for (auto ptr : {&aPtr, &bPtr, &cPtr, &xPtr, &yPtr, &zPtr}) {
+      *ptr = malloc_device<float>(size, usmQueue);
+    }
+  }
+
+  ~workload() {
+    for (auto ptr : {aPtr, bPtr, cPtr, xPtr, yPtr, zPtr}) {
+      free(ptr, usmQueue);
+    }
+  }
+
+  bool check() const {
+    for (size_t i = 0; i < size; ++i) {
+      if (z[i] != static_cast<float>(2 * i + 2)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  queue& usmQueue;
+  size_t size;
+  std::vector<float> a, b, c, z;
+  float *aPtr, *bPtr, *cPtr, *xPtr, *yPtr, *zPtr;
+};
+
+static void build_graph(cppcon::task_graph& graph, workload& w) {
+  const auto bytes = w.size * sizeof(float);
+  auto all = [&](float* ptr) { return cppcon::make_usm_range(ptr, w.size); };
+
+  graph.add_copy(w.aPtr, w.a.data(), bytes);
+  graph.add_copy(w.bPtr, w.b.data(), bytes);
+  graph.add_copy(w.cPtr, w.c.data(), bytes);
+  graph.add_kernel({all(w.aPtr), all(w.bPtr)}, {all(w.xPtr)},
+    add_cgf<add_x>(w.aPtr, w.bPtr, w.xPtr, w.size));
+  graph.add_kernel({all(w.bPtr), all(w.cPtr)}, {all(w.yPtr)},
+    add_cgf<add_y>(w.bPtr, w.cPtr, w.yPtr, w.size));
+  graph.add_kernel({all(w.xPtr), all(w.yPtr)}, {all(w.zPtr)},
+    add_cgf<add_z>(w.xPtr, w.yPtr, w.zPtr, w.size));
+  graph.add_copy(w.z.data(), w.zPtr, bytes);
+}
+
+static void run_hand_wired(workload& w) {
+  const auto bytes = w.size * sizeof(float);
+  auto& q = w.usmQueue;
+
+  auto copyA = q.memcpy(w.aPtr, w.a.data(), bytes);
+  auto copyB = q.memcpy(w.bPtr, w.b.data(), bytes);
+  auto copyC = q.memcpy(w.cPtr, w.c.data(), bytes);
+
+  auto addX = q.submit([&](handler& cgh) {
+    cgh.depends_on(copyA);
+    cgh.depends_on(copyB);
+    add_cgf<add_x>(w.aPtr, w.bPtr, w.xPtr, w.size)(cgh);
+  });
+  auto addY = q.submit([&](handler& cgh) {
+    cgh.depends_on(copyB);
+    cgh.depends_on(copyC);
+    add_cgf<add_y>(w.bPtr, w.cPtr, w.yPtr, w.size)(cgh);
+  });
+  auto addZ = q.submit([&](handler& cgh) {
+    cgh.depends_on(addX);
+    cgh.depends_on(addY);
+    add_cgf<add_z>(w.xPtr, w.yPtr, w.zPtr, w.size)(cgh);
+  });
+  q.submit([&](handler& cgh) {
+    cgh.depends_on(addZ);
+    cgh.memcpy(w.z.data(), w.zPtr, bytes);
+  }).wait();
+}
+
+static void run_serialized(workload& w) {
+  const auto bytes = w.size * sizeof(float);
+  auto& q = w.usmQueue;
+
+  q.memcpy(w.aPtr, w.a.data(), bytes).wait();
+  q.memcpy(w.bPtr, w.b.data(), bytes).wait();
+  q.memcpy(w.cPtr, w.c.data(), bytes).wait();
+  q.submit(add_cgf<add_x>(w.aPtr, w.bPtr, w.xPtr, w.size)).wait();
+  q.submit(add_cgf<add_y>(w.bPtr, w.cPtr, w.yPtr, w.size)).wait();
+  q.submit(add_cgf<add_z>(w.xPtr, w.yPtr, w.zPtr, w.size)).wait();
+  q.memcpy(w.z.data(), w.zPtr, bytes).wait();
+}
+
+TEST_CASE("inferred_dependencies", "sycl_07_unified_shared_memory_ext") {
+  auto usmQueue = queue{usm_device_selector{}};
+  workload w{usmQueue, 1024};
+
+  cppcon::task_graph graph{usmQueue};
+  build_graph(graph, w);
+
+  using ids = std::vector<cppcon::task_graph::node_id>;
+
+  REQUIRE(graph.get_dependencies(0).empty());
+  REQUIRE(graph.get_dependencies(1).empty());
+  REQUIRE(graph.get_dependencies(2).empty());
+  REQUIRE(graph.get_dependencies(3) == ids{1, 0});
+  REQUIRE(graph.get_dependencies(4) == ids{2, 1});
+  REQUIRE(graph.get_dependencies(5) == ids{4, 3});
+  REQUIRE(graph.get_dependencies(6) == ids{5});
+  REQUIRE(graph.num_edges() == 7);
+
+  graph.submit();
+  graph.wait();
+
+  REQUIRE(w.check());
+}
+
+TEST_CASE("transitive_reduction", "sycl_07_unified_shared_memory_ext") {
+  auto usmQueue = queue{usm_device_selector{}};
+  const size_t size = 1024;
+
+  auto ptr = malloc_device<int>(size, usmQueue);
+  std::vector<int> result(size);
+
+  /* Each fill overwrites the last, so each only needs to wait on the one
+   * before it, and the copy only on the last fill. Disjoint halves don't
+   * depend on each other at all. */
+  cppcon::task_graph graph{usmQueue};
+  graph.add_fill(ptr, 1, size);
+  graph.add_fill(ptr, 2, size);
+  graph.add_fill(ptr, 3, size / 2);
+  graph.add_fill(ptr + size / 2, 4, size / 2);
+  graph.add_copy(result.data(), ptr, size * sizeof(int));
+
+  using ids = std::vector<cppcon::task_graph::node_id>;
+
+  REQUIRE(graph.get_dependencies(1) == ids{0});
+  REQUIRE(graph.get_dependencies(2) == ids{1});
+  REQUIRE(graph.get_dependencies(3) == ids{1});
+  REQUIRE(graph.get_dependencies(4) == ids{3, 2});
+  REQUIRE(graph.num_edges() == 5);
+
+  graph.submit();
+  graph.wait();
+
+  REQUIRE(result.front() == 3);
+  REQUIRE(result.back() == 4);
+
+  free(ptr, usmQueue);
+}
+
+class accumulate;
+
+TEST_CASE("replay", "sycl_07_unified_shared_memory_ext") {
+  auto usmQueue = queue{usm_device_selector{}};
+  const size_t size = 1024;
+  const size_t iterations = 10;
+
+  auto sumPtr = malloc_device<int>(size, usmQueue);
+  std::vector<int> result(size);
+
+  usmQueue.fill(sumPtr, 0, size).wait();
+
+  /* Each replay reads the sum written by the previous one. */
+  cppcon::task_graph graph{usmQueue};
+  graph.add_kernel({cppcon::make_usm_range(sumPtr, size)},
+    {cppcon::make_usm_range(sumPtr, size)}, [=](handler& cgh) {
+      auto sum = cppcon::make_usm_pointer(sumPtr);
+      cgh.parallel_for<accumulate>(range<1>(size), [=](id<1> idx) {
+        sum[idx[0]] += static_cast<int>(idx[0]);
+      });
+    });
+  graph.add_copy(result.data(), sumPtr, size * sizeof(int));
+
+  graph.replay(iterations);
+  graph.wait();
+
+  for (size_t i = 0; i < size; ++i) {
+    REQUIRE(result[i] == static_cast<int>(i * iterations));
+  }
+
+  free(sumPtr, usmQueue);
+}
+
+TEST_CASE("task_graph_submission", "sycl_07_unified_shared_memory_ext") {
+  const size_t size = 1 << 20;
+
+  auto usmQueue = queue{usm_device_selector{}};
+  workload w{usmQueue, size};
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("serialized", cppcon::benchmark(
+    [&]() { run_serialized(w); }, 100, "serialized"));
+  REQUIRE(w.check());
+
+  results.emplace_back("hand-wired", cppcon::benchmark(
+    [&]() { run_hand_wired(w); }, 100, "hand-wired"));
+  REQUIRE(w.check());
+
+  results.emplace_back("task_graph", cppcon::benchmark(
+    [&]() {
+      cppcon::task_graph graph{usmQueue};
+      build_graph(graph, w);
+      graph.submit();
+      graph.wait();
+    },
+    100, "task_graph"));
+  REQUIRE(w.check());
+
+  cppcon::task_graph graph{usmQueue};
+  build_graph(graph, w);
+
+  results.emplace_back("task_graph replay", cppcon::benchmark(
+    [&]() {
+      graph.submit();
+      graph.wait();
+    },
+    100, "task_graph replay"));
+  REQUIRE(w.check());
+
+  cppcon::print_comparison(results, "z = (a + b) + (b + c) (" +
+    std::to_string(size) + " floats)");
+}
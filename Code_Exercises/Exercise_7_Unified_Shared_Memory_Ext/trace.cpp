@@ -0,0 +1,148 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define SYCL_ACADEMY_USING_COMPUTECPP
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+#include <SYCL/experimental/usm_wrapper.h>
+#include <CL/sycl.hpp>
+#include <SYCL/experimental.hpp>
+#define depends_on experimental_depends_on
+using namespace cl::sycl::experimental;
+#else  // SYCL_ACADEMY_USING_COMPUTECPP
+#include <CL/sycl.hpp>
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+#include <chrome_trace.h>
+#include <usm_pointer.h>
+
+#include <algorithm>
+#include <numeric>
+
+using namespace cl::sycl;
+
+struct usm_device_selector : public cl::sycl::device_selector {
+  int operator()(const cl::sycl::device& d) const override {
+    if (d.get_info<info::device::usm_device_allocations>()) {
+      return 1;
+    }
+    else {
+      return -1;
+    }
+  }
+};
+
+template <typename T>
+class traced_usm_add;
+
+/* The vector add of solution.cpp, with the output cleared by a fill first so
+ * that every kind of device span shows up on the timeline. */
+template <typename T>
+void traced_vector_add(cppcon::traced_queue& queue,
+                       const std::vector<T>& inputA,
+                       const std::vector<T>& inputB, std::vector<T>& output) {
+  auto& usmQueue = queue.get_queue();
+  const auto size = inputA.size();
+
+  auto inputAPtr = malloc_device<T>(size, usmQueue);
+  auto inputBPtr = malloc_device<T>(size, usmQueue);
+  auto outputPtr = malloc_device<T>(size, usmQueue);
+
+  auto copyInputA = queue.memcpy("copy a", inputAPtr, inputA.data(), size);
+  auto copyInputB = queue.memcpy("copy b", inputBPtr, inputB.data(), size);
+  auto clearOutput = queue.fill("clear output", outputPtr, T{}, size);
+
+  auto add = queue.submit("vector add", [&](handler &cgh) {
+    cgh.depends_on(copyInputA);
+    cgh.depends_on(copyInputB);
+    cgh.depends_on(clearOutput);
+
+    auto inAPtr = cppcon::make_usm_pointer(inputAPtr);
+    auto inBPtr = cppcon::make_usm_pointer(inputBPtr);
+    auto outPtr = cppcon::make_usm_pointer(outputPtr);
+
+    cgh.parallel_for<traced_usm_add<T>>(range<1>(size), [=](id<1> idx) {
+      auto index = idx[0];
+      outPtr[index] += inAPtr[index] + inBPtr[index];
+    });
+  });
+
+  queue.memcpy("copy output", output.data(), outputPtr, size, {add});
+  queue.wait();
+
+  free(inputAPtr, usmQueue);
+  free(inputBPtr, usmQueue);
+  free(outputPtr, usmQueue);
+}
+
+static size_t count_spans(const cppcon::trace_timeline& timeline,
+                          const std::string& category) {
+  auto spans = timeline.spans();
+  return std::count_if(spans.begin(), spans.end(),
+                       [&](const cppcon::trace_span& span) {
+                         return span.category == category;
+                       });
+}
+
+/* Writes usm_vector_add.json if SYCL_ACADEMY_TRACE is set. */
+TEST_CASE("traced_usm_vector_add", "sycl_07_unified_shared_memory_ext") {
+  const size_t size = 1 << 20;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size, 0.0f);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  cppcon::trace_timeline timeline{"usm_vector_add"};
+  cppcon::traced_queue queue{timeline, usm_device_selector{}.select_device(),
+                             "usm queue"};
+
+  traced_vector_add(queue, inputA, inputB, output);
+
+  REQUIRE(output[size - 1] == static_cast<float>((size - 1) * 2));
+
+  if (timeline.enabled()) {
+    REQUIRE(timeline.save());
+    std::cout << "trace written to " << timeline.path() << "\n";
+  }
+}
+
+TEST_CASE("usm_trace_events", "sycl_07_unified_shared_memory_ext") {
+  const size_t size = 1024;
+
+  std::vector<float> inputA(size, 1.0f);
+  std::vector<float> inputB(size, 2.0f);
+  std::vector<float> output(size, 0.0f);
+
+  cppcon::trace_timeline timeline{"usm_trace_events", true};
+  cppcon::traced_queue queue{timeline, usm_device_selector{}.select_device(),
+                             "usm queue"};
+
+  traced_vector_add(queue, inputA, inputB, output);
+  REQUIRE(output[0] == 3.0f);
+
+  /* No accessors are involved with USM. */
+  REQUIRE(count_spans(timeline, "submit") == 5);
+  REQUIRE(count_spans(timeline, "accessor") == 0);
+  REQUIRE(count_spans(timeline, "wait") == 1);
+  REQUIRE(count_spans(timeline, "copy") == 3);
+  REQUIRE(count_spans(timeline, "fill") == 1);
+  REQUIRE(count_spans(timeline, "kernel") == 1);
+
+  /* Each submission is collected once, so waiting again adds only a wait. */
+  queue.wait();
+  REQUIRE(count_spans(timeline, "wait") == 2);
+  REQUIRE(timeline.spans().size() == 12);
+}
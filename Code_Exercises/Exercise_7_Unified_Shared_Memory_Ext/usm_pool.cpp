@@ -0,0 +1,235 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define SYCL_ACADEMY_USING_COMPUTECPP
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+#include <SYCL/experimental/usm_wrapper.h>
+#include <CL/sycl.hpp>
+#include <SYCL/experimental.hpp>
+#define depends_on experimental_depends_on
+using namespace cl::sycl::experimental;
+#else  // SYCL_ACADEMY_USING_COMPUTECPP
+#include <CL/sycl.hpp>
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+#include <benchmark.h>
+#include <usm_pool.h>
+
+#include <cstdint>
+#include <numeric>
+
+using namespace cl::sycl;
+
+struct usm_device_selector : public cl::sycl::device_selector {
+  int operator()(const cl::sycl::device& d) const override {
+    if (d.get_info<info::device::usm_device_allocations>()) {
+      return 1;
+    }
+    else {
+      return -1;
+    }
+  }
+};
+
+template <typename T>
+class add;
+
+template <typename T>
+class add_pooled;
+
+/* The solution, allocating and freeing device memory on every call. */
+template <typename T>
+void parallel_add(queue& usmQueue, std::vector<T>& inputA,
+  std::vector<T>& inputB, std::vector<T>& output) {
+  const auto size = inputA.size();
+  const auto sizeInBytes = size * sizeof(T);
+
+  auto inputAPtr = malloc_device<T>(size, usmQueue);
+  auto inputBPtr = malloc_device<T>(size, usmQueue);
+  auto outputPtr = malloc_device<T>(size, usmQueue);
+
+  auto copyInputA = usmQueue.memcpy(inputAPtr, inputA.data(), sizeInBytes);
+  auto copyInputB = usmQueue.memcpy(inputBPtr, inputB.data(), sizeInBytes);
+
+  usmQueue.submit([&](handler &cgh) {
+    cgh.depends_on(copyInputA);
+    cgh.depends_on(copyInputB);
+
+    auto inAPtr = cppcon::make_usm_pointer(inputAPtr);
+    auto inBPtr = cppcon::make_usm_pointer(inputBPtr);
+    auto outPtr = cppcon::make_usm_pointer(outputPtr);
+
+    cgh.parallel_for<add<T>>(range<1>(size), [=](id<1> idx) {
+      auto index = idx[0];
+      outPtr[index] = inAPtr[index] + inBPtr[index];
+    });
+  }).wait();
+
+  usmQueue.memcpy(output.data(), outputPtr, sizeInBytes).wait();
+
+  free(inputAPtr, usmQueue);
+  free(inputBPtr, usmQueue);
+  free(outputPtr, usmQueue);
+}
+
+/* The same, but taking device memory from a pool. The blocks are returned to
+ * the pool when the unique_ptrs go out of scope, after the final wait. */
+template <typename T>
+void parallel_add(cppcon::usm_pool& pool, std::vector<T>& inputA,
+  std::vector<T>& inputB, std::vector<T>& output) {
+  const auto size = inputA.size();
+  const auto sizeInBytes = size * sizeof(T);
+
+  auto& usmQueue = pool.get_queue();
+
+  auto inputAPtr = pool.make_unique<T>(size);
+  auto inputBPtr = pool.make_unique<T>(size);
+  auto outputPtr = pool.make_unique<T>(size);
+
+  auto copyInputA =
+    usmQueue.memcpy(inputAPtr.get(), inputA.data(), sizeInBytes);
+  auto copyInputB =
+    usmQueue.memcpy(inputBPtr.get(), inputB.data(), sizeInBytes);
+
+  usmQueue.submit([&](handler &cgh) {
+    cgh.depends_on(copyInputA);
+    cgh.depends_on(copyInputB);
+
+    auto inAPtr = cppcon::make_usm_pointer(inputAPtr.get());
+    auto inBPtr = cppcon::make_usm_pointer(inputBPtr.get());
+    auto outPtr = cppcon::make_usm_pointer(outputPtr.get());
+
+    cgh.parallel_for<add_pooled<T>>(range<1>(size), [=](id<1> idx) {
+      auto index = idx[0];
+      outPtr[index] = inAPtr[index] + inBPtr[index];
+    });
+  }).wait();
+
+  usmQueue.memcpy(output.data(), outputPtr.get(), sizeInBytes).wait();
+}
+
+TEST_CASE("size_classes", "sycl_07_unified_shared_memory_ext") {
+  using cppcon::usm_pool;
+
+  REQUIRE(usm_pool::size_class(1) == 256);
+  REQUIRE(usm_pool::size_class(256) == 256);
+  REQUIRE(usm_pool::size_class(257) == 320);
+  REQUIRE(usm_pool::size_class(4096) == 4096);
+  REQUIRE(usm_pool::size_class(4097) == 5120);
+
+  for (size_t bytes = 1; bytes < (1 << 20); bytes = bytes * 3 + 1) {
+    auto blockSize = usm_pool::size_class(bytes);
+    REQUIRE(blockSize >= bytes);
+    REQUIRE(blockSize * 4 <= std::max<size_t>(bytes, 256) * 5);
+  }
+}
+
+TEST_CASE("pooled_add", "sycl_07_unified_shared_memory_ext") {
+  const int size = 1024;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  cppcon::usm_pool pool{queue{usm_device_selector{}}};
+
+  for (int iteration = 0; iteration < 10; ++iteration) {
+    std::fill(begin(output), end(output), 0.0f);
+
+    parallel_add(pool, inputA, inputB, output);
+
+    for (int i = 0; i < size; i++) {
+      REQUIRE(output[i] == static_cast<float>(i * 2.0f));
+    }
+  }
+
+  auto stats = pool.stats();
+
+  REQUIRE(stats.requests == 30);
+  REQUIRE(stats.hits == 27);
+  REQUIRE(stats.bytesInUse == 0);
+  REQUIRE(stats.peakBytesInUse == 3 * size * sizeof(float));
+  REQUIRE(stats.bytesReserved == 3 * size * sizeof(float));
+
+  pool.trim();
+
+  REQUIRE(pool.stats().bytesReserved == 0);
+}
+
+TEST_CASE("arena", "sycl_07_unified_shared_memory_ext") {
+  cppcon::usm_pool pool{queue{usm_device_selector{}}};
+  cppcon::usm_arena arena{pool, 4096};
+
+  auto a = arena.allocate<float>(100);
+  auto b = arena.allocate<float>(100);
+
+  REQUIRE(reinterpret_cast<uintptr_t>(a) % cppcon::usm_arena::alignment == 0);
+  REQUIRE(reinterpret_cast<uintptr_t>(b) % cppcon::usm_arena::alignment == 0);
+  REQUIRE(b >= a + 100);
+
+  /* Outgrowing the slab adds another, and reset replaces them with one large
+   * enough for the whole iteration. */
+  arena.allocate<float>(2000);
+  REQUIRE(pool.stats().bytesInUse > 4096);
+
+  auto used = arena.used();
+  arena.reset();
+
+  REQUIRE(arena.used() == 0);
+  REQUIRE(arena.capacity() >= used);
+
+  arena.allocate<float>(100);
+  arena.allocate<float>(100);
+  arena.allocate<float>(2000);
+  REQUIRE(arena.used() == used);
+  REQUIRE(pool.stats().bytesInUse == cppcon::usm_pool::size_class(
+    arena.capacity()));
+}
+
+TEST_CASE("pooled_add_latency", "sycl_07_unified_shared_memory_ext") {
+  const int size = 1 << 16;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  auto usmQueue = queue{usm_device_selector{}};
+  cppcon::usm_pool pool{usmQueue};
+
+  std::vector<cppcon::benchmark_result> results;
+
+  results.emplace_back("malloc_device/free", cppcon::benchmark(
+    [&]() { parallel_add(usmQueue, inputA, inputB, output); }, 100,
+    "malloc_device/free"));
+
+  results.emplace_back("usm_pool", cppcon::benchmark(
+    [&]() { parallel_add(pool, inputA, inputB, output); }, 100,
+    "usm_pool"));
+
+  REQUIRE(output[size - 1] == static_cast<float>((size - 1) * 2.0f));
+
+  auto stats = pool.stats();
+  std::cout << "usm_pool: hit rate " << stats.hit_rate() * 100.0
+            << "%, peak " << stats.peakBytesInUse << " bytes, reserved "
+            << stats.bytesReserved << " bytes\n";
+
+  cppcon::print_comparison(results, "parallel_add (" + std::to_string(size) +
+    " floats)");
+}
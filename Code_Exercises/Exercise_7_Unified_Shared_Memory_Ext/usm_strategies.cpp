@@ -0,0 +1,276 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define SYCL_ACADEMY_USING_COMPUTECPP
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+#include <SYCL/experimental/usm_wrapper.h>
+#include <CL/sycl.hpp>
+#include <SYCL/experimental.hpp>
+#define depends_on experimental_depends_on
+using namespace cl::sycl::experimental;
+#else  // SYCL_ACADEMY_USING_COMPUTECPP
+#include <CL/sycl.hpp>
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+#include <benchmark.h>
+#include <usm_pointer.h>
+#include <usm_pool.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iterator>
+#include <numeric>
+
+/* The advice passed to mem_advise for the inputs. Advice values are specific
+ * to the backend, so set this to the backend's equivalent of "read mostly",
+ * for example PI_MEM_ADVICE_CUDA_SET_READ_MOSTLY with DPC++ on CUDA. The
+ * default of 0 asks for the default behaviour. */
+#ifndef SYCL_ACADEMY_MEM_ADVICE
+#define SYCL_ACADEMY_MEM_ADVICE 0
+#endif
+
+using namespace cl::sycl;
+
+struct usm_device_selector : public cl::sycl::device_selector {
+  int operator()(const cl::sycl::device& d) const override {
+    if (d.get_info<info::device::usm_device_allocations>() &&
+        d.get_info<info::device::usm_host_allocations>() &&
+        d.get_info<info::device::usm_shared_allocations>()) {
+      return 1;
+    }
+    else {
+      return -1;
+    }
+  }
+};
+
+enum class usm_strategy {
+  /* Zero-copy: the kernel reads and writes host memory directly. */
+  host,
+  /* Migrated by the runtime on first access. */
+  shared,
+  /* As shared, but migrated to the device ahead of the kernel. */
+  shared_prefetch,
+  /* Explicit copies to and from device memory, as in the solution. */
+  device
+};
+
+static const usm_strategy strategies[] = {
+  usm_strategy::host, usm_strategy::shared, usm_strategy::shared_prefetch,
+  usm_strategy::device};
+
+static std::string to_string(usm_strategy strategy) {
+  switch (strategy) {
+    case usm_strategy::host: return "host";
+    case usm_strategy::shared: return "shared";
+    case usm_strategy::shared_prefetch: return "shared+prefetch";
+    default: return "device";
+  }
+}
+
+/* Allocations are tracked, so the benchmarks report their USM footprint. */
+template <typename T>
+cppcon::tracking_usm_allocator<T> allocator(queue& usmQueue,
+  usm_strategy strategy) {
+  switch (strategy) {
+    case usm_strategy::host:
+      return cppcon::tracking_usm_allocator<T>{usmQueue,
+        cppcon::usm_kind::host};
+    case usm_strategy::device:
+      return cppcon::tracking_usm_allocator<T>{usmQueue,
+        cppcon::usm_kind::device};
+    default:
+      return cppcon::tracking_usm_allocator<T>{usmQueue,
+        cppcon::usm_kind::shared};
+  }
+}
+
+template <typename T>
+class add;
+
+template <typename T>
+event submit_add(queue& usmQueue, T* inputAPtr, T* inputBPtr, T* outputPtr,
+  size_t size, const std::vector<event>& dependencies) {
+  return usmQueue.submit([&](handler &cgh) {
+    for (auto& dependency : dependencies) {
+      cgh.depends_on(dependency);
+    }
+
+    auto inAPtr = cppcon::make_usm_pointer(inputAPtr);
+    auto inBPtr = cppcon::make_usm_pointer(inputBPtr);
+    auto outPtr = cppcon::make_usm_pointer(outputPtr);
+
+    cgh.parallel_for<add<T>>(range<1>(size), [=](id<1> idx) {
+      auto index = idx[0];
+      outPtr[index] = inAPtr[index] + inBPtr[index];
+    });
+  });
+}
+
+/* Runs the vector add passes times over the same inputs, from host data in
+ * to host data out, including allocation, so that a single pass shows the
+ * cost of getting data to and from the device and repeated passes show the
+ * cost of accessing it once it is there. */
+template <typename T>
+void parallel_add(queue& usmQueue, usm_strategy strategy,
+  const std::vector<T>& inputA, const std::vector<T>& inputB,
+  std::vector<T>& output, int passes) {
+  const auto size = inputA.size();
+  const auto sizeInBytes = size * sizeof(T);
+
+  auto alloc = allocator<T>(usmQueue, strategy);
+  auto inputAPtr = alloc.allocate(size);
+  auto inputBPtr = alloc.allocate(size);
+  auto outputPtr = alloc.allocate(size);
+
+  std::vector<event> dependencies;
+
+  if (strategy == usm_strategy::device) {
+    dependencies.push_back(
+      usmQueue.memcpy(inputAPtr, inputA.data(), sizeInBytes));
+    dependencies.push_back(
+      usmQueue.memcpy(inputBPtr, inputB.data(), sizeInBytes));
+  } else {
+    std::copy(inputA.begin(), inputA.end(), inputAPtr);
+    std::copy(inputB.begin(), inputB.end(), inputBPtr);
+  }
+
+  if (strategy == usm_strategy::shared_prefetch) {
+    dependencies.push_back(usmQueue.mem_advise(inputAPtr, sizeInBytes,
+      SYCL_ACADEMY_MEM_ADVICE));
+    dependencies.push_back(usmQueue.mem_advise(inputBPtr, sizeInBytes,
+      SYCL_ACADEMY_MEM_ADVICE));
+    dependencies.push_back(usmQueue.prefetch(inputAPtr, sizeInBytes));
+    dependencies.push_back(usmQueue.prefetch(inputBPtr, sizeInBytes));
+  }
+
+  for (int pass = 0; pass < passes; ++pass) {
+    dependencies = {submit_add(usmQueue, inputAPtr, inputBPtr, outputPtr,
+      size, dependencies)};
+  }
+  dependencies.front().wait();
+
+  if (strategy == usm_strategy::device) {
+    usmQueue.memcpy(output.data(), outputPtr, sizeInBytes).wait();
+  } else {
+    std::copy(outputPtr, outputPtr + size, output.begin());
+  }
+
+  alloc.deallocate(inputAPtr, size);
+  alloc.deallocate(inputBPtr, size);
+  alloc.deallocate(outputPtr, size);
+}
+
+TEST_CASE("usm_strategies", "sycl_07_unified_shared_memory_ext") {
+  const int size = 1000;
+
+  std::vector<float> inputA(size);
+  std::vector<float> inputB(size);
+  std::vector<float> output(size);
+
+  std::iota(begin(inputA), end(inputA), 0.0f);
+  std::iota(begin(inputB), end(inputB), 0.0f);
+
+  auto usmQueue = queue{usm_device_selector{}};
+
+  for (auto strategy : strategies) {
+    for (int passes : {1, 3}) {
+      std::fill(begin(output), end(output), 0.0f);
+
+      parallel_add(usmQueue, strategy, inputA, inputB, output, passes);
+
+      for (int i = 0; i < size; i++) {
+        REQUIRE(output[i] == static_cast<float>(i * 2.0f));
+      }
+    }
+  }
+}
+
+TEST_CASE("usm_strategy_crossover", "sycl_07_unified_shared_memory_ext") {
+  const size_t sizes[] = {1 << 10, 1 << 12, 1 << 14, 1 << 16, 1 << 18,
+                          1 << 20, 1 << 22};
+  const int patterns[] = {1, 16};
+
+  auto usmQueue = queue{usm_device_selector{}};
+
+  std::cout << "Device: "
+            << usmQueue.get_device().get_info<info::device::name>() << "\n\n";
+
+  for (int passes : patterns) {
+    std::vector<std::vector<double>> times;
+
+    for (auto size : sizes) {
+      std::vector<float> inputA(size, 1.0f);
+      std::vector<float> inputB(size, 2.0f);
+      std::vector<float> output(size);
+
+      times.emplace_back();
+      for (auto strategy : strategies) {
+        auto caption = to_string(strategy) + ", " + std::to_string(size) +
+          " floats, " + std::to_string(passes) + " pass(es)";
+        times.back().push_back(cppcon::benchmark(
+          [&]() {
+            parallel_add(usmQueue, strategy, inputA, inputB, output, passes);
+          },
+          10, caption).count());
+
+        REQUIRE(output[size - 1] == 3.0f);
+      }
+    }
+
+    std::cout << "Vector add, " << passes << " pass(es), time in ms\n";
+    std::cout << std::setw(10) << "floats";
+    for (auto strategy : strategies) {
+      std::cout << std::setw(18) << to_string(strategy);
+    }
+    std::cout << std::setw(18) << "fastest" << "\n";
+
+    /* A crossover is where the fastest strategy changes from one size to the
+     * next. Differences within 5% are treated as noise, so the previous
+     * strategy is kept unless another beats it by more than that. */
+    const double tolerance = 1.05;
+    size_t previous = std::size(strategies);
+    std::vector<std::string> crossovers;
+    for (size_t s = 0; s < times.size(); ++s) {
+      std::cout << std::setw(10) << sizes[s];
+      for (auto time : times[s]) {
+        std::cout << std::setw(18) << time;
+      }
+
+      size_t fastest = std::distance(times[s].begin(),
+        std::min_element(times[s].begin(), times[s].end()));
+      std::cout << std::setw(18) << to_string(strategies[fastest]) << "\n";
+
+      if (previous != std::size(strategies) && fastest != previous) {
+        if (times[s][previous] <= times[s][fastest] * tolerance) {
+          continue;
+        }
+        crossovers.push_back(to_string(strategies[previous]) + " -> " +
+          to_string(strategies[fastest]) + " at " + std::to_string(sizes[s]) +
+          " floats");
+      }
+      previous = fastest;
+    }
+
+    std::cout << "Crossover points:";
+    if (crossovers.empty()) {
+      std::cout << " none, " << to_string(strategies[previous])
+                << " is fastest at every size";
+    }
+    for (const auto& crossover : crossovers) {
+      std::cout << "\n  " << crossover;
+    }
+    std::cout << "\n\n";
+  }
+}
@@ -0,0 +1,183 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <async_errors.h>
+#include <benchmark.h>
+
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <thread>
+
+class good_kernel;
+class bad_kernel;
+class blocked_kernel;
+class pipeline_kernel;
+
+/* As in the solution, an nd_range whose local range doesn't divide the
+ * global range. */
+static void submit_bad(cl::sycl::handler& cgh) {
+  auto range = cl::sycl::nd_range<1>(cl::sycl::range<1>(1),
+                                     cl::sycl::range<1>(10));
+  cgh.parallel_for<bad_kernel>(range, [=](cl::sycl::nd_item<1>) {});
+}
+
+static void submit_good(cl::sycl::handler& cgh) {
+  cgh.single_task<good_kernel>([=]() {});
+}
+
+TEST_CASE("attributed_errors", "sycl_08_error_handling") {
+  cppcon::async_error_collector collector;
+  cl::sycl::queue queue(cl::sycl::default_selector{}, collector.handler());
+
+  collector.submit(queue, "good 1", submit_good);
+  collector.submit(queue, "good 2", submit_good);
+  auto bad = collector.submit(queue, "bad", submit_bad);
+  collector.submit(queue, "good 3", submit_good);
+
+  collector.wait(queue);
+
+  /* This relies on the runtime raising the error at submit, or delivering it
+   * through the bad submission's own event. One which hands it to the
+   * wait_and_throw of an earlier event would have it attributed to "good 1"
+   * or "good 2"; see the limitation described by async_error_collector. */
+  REQUIRE(collector.in_flight() == 0);
+  REQUIRE(collector.errors().size() == 1);
+
+  const auto& error = collector.errors().front();
+  std::cout << error.message() << "\n";
+
+  REQUIRE(error.submission == bad);
+  REQUIRE(error.tag == "bad");
+  REQUIRE(!error.timedOut);
+
+  REQUIRE_THROWS_AS(collector.rethrow(), cppcon::async_submission_error);
+  REQUIRE(!collector.has_errors());
+  REQUIRE_NOTHROW(collector.rethrow());
+}
+
+TEST_CASE("watchdog", "sycl_08_error_handling") {
+  cppcon::async_error_collector collector{std::chrono::milliseconds(1)};
+  cl::sycl::queue queue(cl::sycl::default_selector{}, collector.handler());
+
+  cl::sycl::buffer<int, 1> buf{cl::sycl::range<1>(1)};
+
+  size_t blocked;
+  {
+    /* The kernel can't start while the host accessor is alive. */
+    auto hostAcc = buf.get_access<cl::sycl::access::mode::write>();
+    hostAcc[0] = 0;
+
+    blocked = collector.submit(queue, "blocked", [&](cl::sycl::handler& cgh) {
+      auto acc = buf.get_access<cl::sycl::access::mode::read_write>(cgh);
+      cgh.single_task<blocked_kernel>([=]() { acc[0] += 1; });
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    collector.poll(queue);
+
+    /* Unless the runtime ran the kernel when it was submitted, it's still
+     * in flight and the watchdog has fired. */
+    if (collector.in_flight() == 1) {
+      REQUIRE(collector.errors().size() == 1);
+      REQUIRE(collector.errors().front().submission == blocked);
+      REQUIRE(collector.errors().front().timedOut);
+
+      /* It only fires once. */
+      collector.poll(queue);
+      REQUIRE(collector.errors().size() == 1);
+    }
+  }
+
+  /* Once unblocked it completes, without error, and is retired. */
+  while (collector.in_flight() > 0) {
+    collector.poll(queue);
+  }
+  REQUIRE(std::all_of(collector.errors().begin(), collector.errors().end(),
+                      [](const cppcon::async_error& e) { return e.timedOut; }));
+  REQUIRE(buf.get_access<cl::sycl::access::mode::read>()[0] == 1);
+}
+
+/* A pipeline of small kernels spread over a few buffers, so that several can
+ * be in flight at once, with errors checked in different ways. */
+TEST_CASE("error_checking_overhead", "sycl_08_error_handling") {
+  const int submissions = 1000;
+  const int bufferCount = 8;
+  const size_t size = 4096;
+
+  std::vector<cl::sycl::buffer<float, 1>> buffers;
+  for (int b = 0; b < bufferCount; ++b) {
+    buffers.emplace_back(cl::sycl::range<1>(size));
+  }
+
+  auto kernel = [&](int k) {
+    return [&, k](cl::sycl::handler& cgh) {
+      auto acc = buffers[k % bufferCount]
+                     .get_access<cl::sycl::access::mode::discard_write>(cgh);
+      cgh.parallel_for<pipeline_kernel>(cl::sycl::range<1>(size),
+        [=](cl::sycl::id<1> idx) {
+          float value = static_cast<float>(idx[0]);
+          for (int i = 0; i < 16; ++i) {
+            value = value * 0.5f + 1.0f;
+          }
+          acc[idx] = value;
+        });
+    };
+  };
+
+  std::vector<cppcon::benchmark_result> results;
+
+  {
+    cppcon::async_error_collector collector;
+    cl::sycl::queue queue(cl::sycl::default_selector{}, collector.handler());
+
+    results.emplace_back("wait_and_throw per submit", cppcon::benchmark(
+      [&]() {
+        for (int k = 0; k < submissions; ++k) {
+          queue.submit(kernel(k));
+          queue.wait_and_throw();
+        }
+      },
+      5, "wait_and_throw per submit"));
+
+    results.emplace_back("wait_and_throw at end", cppcon::benchmark(
+      [&]() {
+        for (int k = 0; k < submissions; ++k) {
+          queue.submit(kernel(k));
+        }
+        queue.wait_and_throw();
+      },
+      5, "wait_and_throw at end"));
+
+    for (int interval : {1, 64}) {
+      auto name = "collector, poll every " + std::to_string(interval);
+      results.emplace_back(name, cppcon::benchmark(
+        [&]() {
+          for (int k = 0; k < submissions; ++k) {
+            collector.submit(queue, "pipeline " + std::to_string(k),
+                             kernel(k));
+            if ((k + 1) % interval == 0) {
+              collector.poll(queue);
+            }
+          }
+          collector.wait(queue);
+        },
+        5, name));
+    }
+
+    REQUIRE(!collector.has_errors());
+  }
+
+  cppcon::print_comparison(results, std::to_string(submissions) +
+    " submissions");
+}
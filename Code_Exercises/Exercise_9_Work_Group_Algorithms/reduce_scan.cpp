@@ -0,0 +1,144 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <reduce_scan.h>
+
+#include <execution>
+#include <functional>
+#include <numeric>
+
+#include <CL/sycl.hpp>
+
+struct maximum {
+  int operator()(int a, int b) const { return a > b ? a : b; }
+};
+
+struct square {
+  long long operator()(int value) const {
+    return static_cast<long long>(value) * value;
+  }
+};
+
+/* Sizes either side of the work-group size, and large enough to need more
+ * than one level of recursion in the scan. */
+static const size_t sizes[] = {1, 255, 256, 257, 100000};
+
+/* Values are kept small so that the sums can't overflow. */
+static std::vector<int> make_input(size_t size) {
+  std::vector<int> input(size);
+  for (size_t i = 0; i < size; ++i) {
+    input[i] = static_cast<int>(i % 97);
+  }
+  return input;
+}
+
+TEST_CASE("reduce", "sycl_09_work_group_algorithms") {
+  cl::sycl::queue defaultQueue;
+
+  for (auto size : sizes) {
+    auto input = make_input(size);
+
+    cl::sycl::buffer<int, 1> inputBuf(input.data(), input.size());
+
+    REQUIRE(cppcon::reduce(defaultQueue, inputBuf, 7, std::plus<int>{}) ==
+            std::reduce(input.begin(), input.end(), 7));
+    REQUIRE(cppcon::reduce(defaultQueue, inputBuf, -1, maximum{}) ==
+            std::reduce(input.begin(), input.end(), -1, maximum{}));
+  }
+}
+
+TEST_CASE("transform_reduce", "sycl_09_work_group_algorithms") {
+  cl::sycl::queue defaultQueue;
+
+  for (auto size : sizes) {
+    auto input = make_input(size);
+
+    cl::sycl::buffer<int, 1> inputBuf(input.data(), input.size());
+
+    REQUIRE(cppcon::transform_reduce(defaultQueue, inputBuf, 0ll,
+                                     std::plus<long long>{}, square{}) ==
+            std::transform_reduce(input.begin(), input.end(), 0ll,
+                                  std::plus<long long>{}, square{}));
+  }
+}
+
+TEST_CASE("scan", "sycl_09_work_group_algorithms") {
+  cl::sycl::queue defaultQueue;
+
+  for (auto size : sizes) {
+    auto input = make_input(size);
+    std::vector<int> inclusive(size);
+    std::vector<int> exclusive(size);
+
+    {
+      cl::sycl::buffer<int, 1> inputBuf(input.data(), input.size());
+      cl::sycl::buffer<int, 1> inclusiveBuf(inclusive.data(), inclusive.size());
+      cl::sycl::buffer<int, 1> exclusiveBuf(exclusive.data(), exclusive.size());
+
+      cppcon::inclusive_scan(defaultQueue, inputBuf, inclusiveBuf,
+                             std::plus<int>{});
+      cppcon::exclusive_scan(defaultQueue, inputBuf, exclusiveBuf, 3,
+                             std::plus<int>{});
+    }
+
+    std::vector<int> expected(size);
+
+    std::inclusive_scan(input.begin(), input.end(), expected.begin());
+    REQUIRE(inclusive == expected);
+
+    std::exclusive_scan(input.begin(), input.end(), expected.begin(), 3);
+    REQUIRE(exclusive == expected);
+  }
+}
+
+TEST_CASE("reduce_throughput", "sycl_09_work_group_algorithms") {
+  const size_t size = 1 << 24;
+
+  std::vector<float> input(size, 1.0f);
+
+  cl::sycl::queue defaultQueue;
+
+  cl::sycl::buffer<float, 1> inputBuf(input.data(), input.size());
+
+  std::vector<cppcon::benchmark_result> results;
+  float serial = 0.0f, parallel = 0.0f, sycl = 0.0f;
+
+  results.emplace_back("std::reduce", cppcon::benchmark(
+    [&]() { serial = std::reduce(input.begin(), input.end(), 0.0f); }, 100,
+    "std::reduce"));
+
+  results.emplace_back("std::reduce par_unseq", cppcon::benchmark(
+    [&]() {
+      parallel = std::reduce(std::execution::par_unseq, input.begin(),
+                             input.end(), 0.0f);
+    },
+    100, "std::reduce par_unseq"));
+
+  results.emplace_back("cppcon::reduce", cppcon::benchmark(
+    [&]() {
+      sycl = cppcon::reduce(defaultQueue, inputBuf, 0.0f, std::plus<float>{});
+    },
+    100, "cppcon::reduce"));
+
+  REQUIRE(serial == static_cast<float>(size));
+  REQUIRE(parallel == static_cast<float>(size));
+  REQUIRE(sycl == static_cast<float>(size));
+
+  std::cout << "cppcon::reduce throughput: "
+            << (size * sizeof(float)) / (results.back().time.count() * 1e6)
+            << "GB/s\n";
+
+  cppcon::print_comparison(results, "reduce (" + std::to_string(size) +
+    " floats)");
+}
@@ -0,0 +1,88 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+class work_group_sum;
+
+static constexpr size_t SIZE = 1 << 20;
+static constexpr size_t WORK_GROUP_SIZE = 256;
+
+TEST_CASE("work_group_sum", "sycl_09_work_group_algorithms") {
+  std::vector<float> input(SIZE);
+  std::vector<float> partialSums(SIZE / WORK_GROUP_SIZE, 0.0f);
+
+  for (size_t i = 0; i < SIZE; ++i) {
+    input[i] = static_cast<float>(i % 8);
+  }
+
+  cl::sycl::queue defaultQueue;
+
+  {
+    cl::sycl::buffer<float, 1> inputBuf(input.data(), input.size());
+    cl::sycl::buffer<float, 1> partialSumsBuf(partialSums.data(),
+                                              partialSums.size());
+
+    cppcon::benchmark(
+      [&]() {
+        defaultQueue.submit([&](cl::sycl::handler& cgh) {
+          auto inputAcc =
+            inputBuf.template get_access<cl::sycl::access::mode::read>(cgh);
+          auto partialSumsAcc =
+            partialSumsBuf
+              .template get_access<cl::sycl::access::mode::discard_write>(
+                cgh);
+
+          auto scratchpad =
+            cl::sycl::accessor<float, 1, cl::sycl::access::mode::read_write,
+            cl::sycl::access::target::local>(
+              cl::sycl::range<1>(WORK_GROUP_SIZE), cgh);
+
+          cgh.parallel_for<work_group_sum>(
+            cl::sycl::nd_range<1>(cl::sycl::range<1>(SIZE),
+                                  cl::sycl::range<1>(WORK_GROUP_SIZE)),
+            [=](cl::sycl::nd_item<1> item) {
+              auto localId = item.get_local_id(0);
+
+              scratchpad[localId] = inputAcc[item.get_global_id(0)];
+
+              /* Halve the number of work-items adding each step, until the
+               * first holds the sum of the tile. */
+              for (size_t stride = WORK_GROUP_SIZE / 2; stride > 0;
+                   stride /= 2) {
+                item.barrier(cl::sycl::access::fence_space::local_space);
+                if (localId < stride) {
+                  scratchpad[localId] += scratchpad[localId + stride];
+                }
+              }
+
+              if (localId == 0) {
+                partialSumsAcc[item.get_group(0)] = scratchpad[0];
+              }
+            });
+          });
+
+        defaultQueue.wait_and_throw();
+      },
+      100, "work_group_sum");
+  }
+
+  auto sum = std::accumulate(partialSums.begin(), partialSums.end(), 0.0f);
+
+  REQUIRE(sum == std::accumulate(input.begin(), input.end(), 0.0f));
+}
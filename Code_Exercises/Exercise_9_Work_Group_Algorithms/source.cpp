@@ -0,0 +1,42 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+
+#include <numeric>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+static constexpr size_t SIZE = 1 << 20;
+static constexpr size_t WORK_GROUP_SIZE = 256;
+
+TEST_CASE("work_group_sum", "sycl_09_work_group_algorithms") {
+  std::vector<float> input(SIZE);
+  std::vector<float> partialSums(SIZE / WORK_GROUP_SIZE, 0.0f);
+
+  for (size_t i = 0; i < SIZE; ++i) {
+    input[i] = static_cast<float>(i % 8);
+  }
+
+  // Task: sum each work-group sized tile of input into partialSums in local
+  // memory, then sum partialSums on the host
+
+  cppcon::benchmark([&]() { /* ... */ }, 100, "work_group_sum");
+
+  // ...
+
+  // Task: compare the sum with std::accumulate of input
+
+  REQUIRE(true);
+}
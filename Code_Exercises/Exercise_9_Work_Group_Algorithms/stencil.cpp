@@ -0,0 +1,213 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+
+#include <benchmark.h>
+#include <stencil.h>
+
+#include <cmath>
+#include <iomanip>
+
+#include <CL/sycl.hpp>
+
+using cppcon::stencil_shape;
+
+/* A hot spot in the middle of a cold plate, with one hot edge. */
+static std::vector<float> make_plate(size_t width, size_t height) {
+  std::vector<float> plate(width * height, 0.0f);
+  for (size_t c = 0; c < width; ++c) {
+    plate[c] = 100.0f;
+  }
+  plate[(height / 2) * width + width / 2] = 1000.0f;
+  return plate;
+}
+
+template <stencil_shape Shape>
+static std::vector<float> host_stencil(
+    std::vector<float> grid, size_t width, size_t height,
+    cppcon::stencil_coefficients<float> coefficients, size_t steps) {
+  auto next = grid;
+  for (size_t step = 0; step < steps; ++step) {
+    for (size_t r = 1; r + 1 < height; ++r) {
+      for (size_t c = 1; c + 1 < width; ++c) {
+        next[r * width + c] = cppcon::apply_stencil<Shape>(
+            coefficients, grid[r * width + c], [&](int dr, int dc) {
+              return grid[(r + dr) * width + c + dc];
+            });
+      }
+    }
+    std::swap(grid, next);
+  }
+  return grid;
+}
+
+static bool approx_equal(const std::vector<float>& a,
+                         const std::vector<float>& b) {
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (std::abs(a[i] - b[i]) > 1e-3f * std::max(1.0f, std::abs(b[i]))) {
+      return false;
+    }
+  }
+  return a.size() == b.size();
+}
+
+/* A grid which isn't a multiple of the tile size in either dimension, and a
+ * number of steps which isn't a multiple of the steps per pass. */
+template <stencil_shape Shape>
+static void check_variants(cppcon::stencil_coefficients<float> coefficients) {
+  const size_t width = 53;
+  const size_t height = 37;
+  const size_t steps = 10;
+
+  cl::sycl::queue defaultQueue;
+
+  const auto plate = make_plate(width, height);
+  const auto expected =
+      host_stencil<Shape>(plate, width, height, coefficients, steps);
+
+  {
+    cppcon::stencil_grid<float> grid{plate, width, height};
+    cppcon::stencil_naive<Shape>(defaultQueue, grid, coefficients, steps);
+    REQUIRE(approx_equal(grid.read(), expected));
+  }
+
+  {
+    cppcon::stencil_grid<float> grid{plate, width, height};
+    cppcon::stencil_tiled<Shape>(defaultQueue, grid, coefficients, steps, 8);
+    REQUIRE(approx_equal(grid.read(), expected));
+  }
+
+  for (size_t stepsPerPass : {1, 3, 4, 16}) {
+    cppcon::stencil_grid<float> grid{plate, width, height};
+    cppcon::stencil_temporal<Shape>(defaultQueue, grid, coefficients, steps,
+                                    stepsPerPass, 8);
+    REQUIRE(approx_equal(grid.read(), expected));
+  }
+}
+
+TEST_CASE("stencil_five_point", "sycl_09_work_group_algorithms") {
+  check_variants<stencil_shape::five_point>(
+      cppcon::stencil_coefficients<float>::heat_five_point(0.2f));
+}
+
+TEST_CASE("stencil_nine_point", "sycl_09_work_group_algorithms") {
+  check_variants<stencil_shape::nine_point>(
+      cppcon::stencil_coefficients<float>::heat_nine_point(0.2f));
+}
+
+TEST_CASE("stencil_ping_pong", "sycl_09_work_group_algorithms") {
+  const size_t width = 16;
+  const size_t height = 16;
+
+  cl::sycl::queue defaultQueue;
+
+  cppcon::stencil_grid<float> grid{make_plate(width, height), width, height};
+  auto& first = grid.current();
+
+  /* An odd number of steps leaves the result in the other buffer, and an
+   * even number of passes leaves it there. */
+  cppcon::stencil_naive<stencil_shape::five_point>(
+      defaultQueue, grid,
+      cppcon::stencil_coefficients<float>::heat_five_point(0.2f), 3);
+  REQUIRE(&grid.current() != &first);
+
+  cppcon::stencil_temporal<stencil_shape::five_point>(
+      defaultQueue, grid,
+      cppcon::stencil_coefficients<float>::heat_five_point(0.2f), 8, 4);
+  REQUIRE(&grid.current() != &first);
+
+  /* The hot edge is held fixed. */
+  auto result = grid.read();
+  REQUIRE(result[width / 2] == 100.0f);
+}
+
+/* Cell updates per second, and the global memory bandwidth implied by
+ * reading and writing every cell once per pass over the grid: once per step
+ * for naive and tiled, once per stepsPerPass steps for temporal. */
+static void print_throughput(
+    const std::vector<cppcon::benchmark_result>& results,
+    const std::vector<size_t>& passes, size_t cells, size_t steps,
+    std::string caption) {
+  const auto precision = std::cout.precision();
+  std::cout << caption << "\n";
+  for (size_t r = 0; r < results.size(); ++r) {
+    const double seconds = results[r].time.count() / 1000.0;
+    const double updates = static_cast<double>(cells) * steps / seconds;
+    const double bytes = 2.0 * sizeof(float) * cells * passes[r] / seconds;
+    std::cout << "  " << std::left << std::setw(24) << results[r].name
+              << std::right << std::setprecision(4) << std::setw(12)
+              << updates / 1e6 << " Mupdates/s" << std::setw(12) << bytes / 1e9
+              << " GB/s\n";
+  }
+  std::cout << "\n";
+  std::cout.precision(precision);
+}
+
+template <stencil_shape Shape>
+static void benchmark_stencil(cl::sycl::queue& queue, size_t size,
+                              cppcon::stencil_coefficients<float> coefficients,
+                              std::string shapeName) {
+  const size_t steps = 16;
+  const size_t stepsPerPass = 4;
+  const int iterations = 3;
+
+  cppcon::stencil_grid<float> grid{make_plate(size, size), size, size};
+
+  std::vector<cppcon::benchmark_result> results;
+  std::vector<size_t> passes;
+
+  results.emplace_back("naive", cppcon::benchmark(
+    [&]() {
+      cppcon::stencil_naive<Shape>(queue, grid, coefficients, steps);
+      queue.wait_and_throw();
+    },
+    iterations, "naive"));
+  passes.push_back(steps);
+
+  results.emplace_back("tiled", cppcon::benchmark(
+    [&]() {
+      cppcon::stencil_tiled<Shape>(queue, grid, coefficients, steps);
+      queue.wait_and_throw();
+    },
+    iterations, "tiled"));
+  passes.push_back(steps);
+
+  results.emplace_back("temporal", cppcon::benchmark(
+    [&]() {
+      cppcon::stencil_temporal<Shape>(queue, grid, coefficients, steps,
+                                      stepsPerPass);
+      queue.wait_and_throw();
+    },
+    iterations, "temporal"));
+  passes.push_back((steps + stepsPerPass - 1) / stepsPerPass);
+
+  const auto caption = shapeName + ", " + std::to_string(size) + "x" +
+                       std::to_string(size) + ", " + std::to_string(steps) +
+                       " steps";
+  cppcon::print_comparison(results, caption);
+  print_throughput(results, passes, size * size, steps, caption);
+}
+
+TEST_CASE("stencil_throughput", "sycl_09_work_group_algorithms") {
+  cl::sycl::queue defaultQueue;
+
+  for (size_t size : {256, 512, 1024}) {
+    benchmark_stencil<stencil_shape::five_point>(
+        defaultQueue, size,
+        cppcon::stencil_coefficients<float>::heat_five_point(0.2f),
+        "5-point");
+    benchmark_stencil<stencil_shape::nine_point>(
+        defaultQueue, size,
+        cppcon::stencil_coefficients<float>::heat_nine_point(0.2f),
+        "9-point");
+  }
+}
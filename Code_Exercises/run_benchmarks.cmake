@@ -0,0 +1,92 @@
+#[[
+  SYCL Academy (c)
+
+  SYCL Academy is licensed under a Creative Commons Attribution-ShareAlike 4.0
+  International License.
+
+  You should have received a copy of the license along with this work.  If not,
+  see <http://creativecommons.org/licenses/by-sa/4.0/>.
+]]
+
+#[[
+  Runs the benchmarks listed, one per line, in BENCHMARK_LIST one after the
+  other, each pinned to BENCHMARK_CPUS with taskset where it's available, and
+  writes a summary followed by the output of each to REPORT. This is what the
+  bench target runs:
+
+    cmake -DBENCHMARK_LIST=<file> -DREPORT=<file> [-DBENCHMARK_CPUS=<cpus>]
+          [-DBENCHMARK_PROFILE=<profile>] -P run_benchmarks.cmake
+]]
+
+foreach(variable BENCHMARK_LIST REPORT)
+  if (NOT ${variable})
+    message(FATAL_ERROR "${variable} must be set")
+  endif()
+endforeach()
+
+file(STRINGS ${BENCHMARK_LIST} benchmarks)
+
+set(launcher "")
+if (NOT "${BENCHMARK_CPUS}" STREQUAL "")
+  find_program(TASKSET taskset)
+  if (TASKSET)
+    set(launcher ${TASKSET} --cpu-list ${BENCHMARK_CPUS})
+    set(pinning "cores ${BENCHMARK_CPUS}")
+  else()
+    set(pinning "not pinned, taskset was not found")
+  endif()
+else()
+  set(pinning "not pinned")
+endif()
+
+cmake_host_system_information(RESULT host QUERY HOSTNAME)
+cmake_host_system_information(RESULT processor QUERY PROCESSOR_DESCRIPTION)
+string(TIMESTAMP started "%Y-%m-%d %H:%M:%S")
+
+set(summary "")
+set(details "")
+set(failures 0)
+list(LENGTH benchmarks count)
+set(index 0)
+
+foreach(benchmark IN LISTS benchmarks)
+  math(EXPR index "${index} + 1")
+  get_filename_component(name ${benchmark} NAME_WE)
+  get_filename_component(directory ${benchmark} DIRECTORY)
+  message(STATUS "[${index}/${count}] ${name}")
+
+  string(TIMESTAMP start "%s")
+  execute_process(
+    COMMAND ${launcher} ${benchmark}
+    WORKING_DIRECTORY ${directory}
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE output
+    RESULT_VARIABLE result)
+  string(TIMESTAMP end "%s")
+  math(EXPR seconds "${end} - ${start}")
+
+  if (result STREQUAL "0")
+    set(status "passed")
+  else()
+    set(status "FAILED (${result})")
+    math(EXPR failures "${failures} + 1")
+    message(STATUS "${name} failed: ${result}")
+  endif()
+
+  string(APPEND summary "  ${name}: ${status}, ${seconds}s\n")
+  string(APPEND details "\n==== ${name} ====\n\n${output}")
+endforeach()
+
+file(WRITE ${REPORT}
+  "SYCL Academy benchmarks\n\n"
+  "  started:   ${started}\n"
+  "  host:      ${host}, ${processor}\n"
+  "  profile:   ${BENCHMARK_PROFILE}\n"
+  "  pinning:   ${pinning}\n\n"
+  "${summary}"
+  "${details}")
+
+message(STATUS "Benchmark report written to ${REPORT}")
+if (failures GREATER 0)
+  message(FATAL_ERROR "${failures} of ${count} benchmarks failed")
+endif()
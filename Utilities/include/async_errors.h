@@ -0,0 +1,282 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __ASYNC_ERRORS_H__
+#define __ASYNC_ERRORS_H__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* An asynchronous error, or a watchdog timeout, with the submission it came
+ * from. submission is 0 for errors which couldn't be attributed, for example
+ * those delivered by a wait_and_throw outside of the collector. */
+struct async_error {
+  size_t submission = 0;
+  std::string tag;
+  std::exception_ptr error;
+  bool timedOut = false;
+
+  std::string message() const {
+    std::string what = timedOut ? "watchdog timeout" : "unknown error";
+    if (error) {
+      try {
+        std::rethrow_exception(error);
+      } catch (const std::exception& e) {
+        what = e.what();
+      } catch (...) {
+      }
+    }
+    if (submission == 0) {
+      return "unattributed: " + what;
+    }
+    return tag + " (submission " + std::to_string(submission) + "): " + what;
+  }
+};
+
+/* Thrown by async_error_collector::rethrow. */
+class async_submission_error : public std::runtime_error {
+ public:
+  explicit async_submission_error(async_error error)
+      : std::runtime_error{error.message()}, error_{std::move(error)} {}
+
+  const async_error& error() const noexcept { return error_; }
+
+ private:
+  async_error error_;
+};
+
+namespace detail {
+
+/* A lock-free queue which any number of threads can push to, and one thread
+ * drains, in the order the values were pushed. */
+template <typename T>
+class mpsc_queue {
+ public:
+  mpsc_queue() = default;
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+  ~mpsc_queue() { drain(); }
+
+  void push(T value) {
+    auto pushed =
+        new node{std::move(value), head_.load(std::memory_order_relaxed)};
+    while (!head_.compare_exchange_weak(pushed->next, pushed,
+                                        std::memory_order_release,
+                                        std::memory_order_relaxed)) {
+    }
+  }
+
+  std::vector<T> drain() {
+    node* head = head_.exchange(nullptr, std::memory_order_acquire);
+    std::vector<T> values;
+    while (head) {
+      values.push_back(std::move(head->value));
+      node* next = head->next;
+      delete head;
+      head = next;
+    }
+    std::reverse(values.begin(), values.end());
+    return values;
+  }
+
+ private:
+  struct node {
+    T value;
+    node* next;
+  };
+
+  std::atomic<node*> head_{nullptr};
+};
+
+}  // namespace detail
+
+/* Collects the errors of work submitted through it without waiting for each
+ * submission, so that a pipeline can keep many submissions in flight and
+ * only check for errors at points of its choosing, with poll.
+ *
+ * Construct the queue with handler() as its async_handler, which pushes
+ * errors into a lock-free queue, so it's safe wherever the runtime calls it
+ * from. poll retires the submissions which have completed, oldest first,
+ * calling wait_and_throw on each one's event so that any error the runtime
+ * delivers is attributed to that submission, and then throw_asynchronous for
+ * anything left over. Synchronous errors from submit are attributed too.
+ *
+ * The attribution is best effort: SYCL 1.2.1 lets event::wait_and_throw pass
+ * the async_handler any unconsumed errors of the queue, not only that event's,
+ * so an error raised by a later submission which has already failed can be
+ * delivered while an earlier one is retired, and be attributed to it. Errors
+ * are never lost, and each is reported once, but where several submissions
+ * fail close together the submission an error names is only where it was
+ * first seen.
+ *
+ * A submission can be given a watchdog timeout, after which poll reports it as
+ * timed out, once; SYCL can't cancel a kernel, so it stays in flight until it
+ * completes. submit, poll and the other members must be called from a single
+ * thread. */
+class async_error_collector {
+ public:
+  using duration = std::chrono::duration<double, std::milli>;
+
+  explicit async_error_collector(duration defaultTimeout = duration::zero())
+      : state_{std::make_shared<state>()}, defaultTimeout_{defaultTimeout} {}
+
+  /* Holds the collector's state by shared_ptr, so the queue may outlive the
+   * collector. */
+  cl::sycl::async_handler handler() const {
+    auto handlerState = state_;
+    return [handlerState](cl::sycl::exception_list exceptions) {
+      const auto submission = handlerState->current.load();
+      for (const auto& e : exceptions) {
+        handlerState->errors.push(async_error{submission, {}, e, false});
+      }
+    };
+  }
+
+  /* Submits cgf to queue, returning the id its errors will be tagged with. */
+  template <typename CommandGroup>
+  size_t submit(cl::sycl::queue& queue, std::string tag, CommandGroup&& cgf) {
+    return submit(queue, std::move(tag), std::forward<CommandGroup>(cgf),
+                  defaultTimeout_);
+  }
+
+  template <typename CommandGroup>
+  size_t submit(cl::sycl::queue& queue, std::string tag, CommandGroup&& cgf,
+                duration timeout) {
+    const size_t id = ++submissions_;
+    try {
+      auto event = queue.submit(std::forward<CommandGroup>(cgf));
+      inFlight_.push_back(submission{id, std::move(tag), event,
+                                     std::chrono::steady_clock::now(),
+                                     timeout, false});
+    } catch (const cl::sycl::exception&) {
+      errors_.push_back(
+          async_error{id, std::move(tag), std::current_exception(), false});
+    }
+    return id;
+  }
+
+  /* Never blocks on work which hasn't completed. Returns the number of new
+   * errors. */
+  size_t poll(cl::sycl::queue& queue) {
+    const auto before = errors_.size();
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto it = inFlight_.begin(); it != inFlight_.end();) {
+      if (is_complete(it->event)) {
+        state_->current = it->id;
+        it->event.wait_and_throw();
+        state_->current = 0;
+        collect(it->id, it->tag);
+        it = inFlight_.erase(it);
+        continue;
+      }
+      if (it->timeout > duration::zero() && !it->timedOut &&
+          now - it->start > it->timeout) {
+        it->timedOut = true;
+        errors_.push_back(async_error{it->id, it->tag, nullptr, true});
+      }
+      ++it;
+    }
+
+    queue.throw_asynchronous();
+    collect(0, {});
+
+    return errors_.size() - before;
+  }
+
+  /* Polls until every submission has completed, or every one still in flight
+   * has timed out. Returns the number of new errors. */
+  size_t wait(cl::sycl::queue& queue,
+              duration pollInterval = std::chrono::microseconds(100)) {
+    size_t newErrors = poll(queue);
+    while (std::any_of(inFlight_.begin(), inFlight_.end(),
+                       [](const submission& s) { return !s.timedOut; })) {
+      std::this_thread::sleep_for(pollInterval);
+      newErrors += poll(queue);
+    }
+    return newErrors;
+  }
+
+  size_t in_flight() const noexcept { return inFlight_.size(); }
+
+  bool has_errors() const noexcept { return !errors_.empty(); }
+
+  const std::vector<async_error>& errors() const noexcept { return errors_; }
+
+  std::vector<async_error> take_errors() {
+    std::vector<async_error> taken;
+    taken.swap(errors_);
+    return taken;
+  }
+
+  /* Throws the oldest collected error as an async_submission_error, if
+   * there is one. */
+  void rethrow() {
+    if (errors_.empty()) {
+      return;
+    }
+    auto error = errors_.front();
+    errors_.erase(errors_.begin());
+    throw async_submission_error{std::move(error)};
+  }
+
+ private:
+  struct state {
+    detail::mpsc_queue<async_error> errors;
+    std::atomic<size_t> current{0};
+  };
+
+  struct submission {
+    size_t id;
+    std::string tag;
+    cl::sycl::event event;
+    std::chrono::steady_clock::time_point start;
+    duration timeout;
+    bool timedOut;
+  };
+
+  static bool is_complete(const cl::sycl::event& event) {
+    return event.get_info<cl::sycl::info::event::command_execution_status>() ==
+           cl::sycl::info::event_command_status::complete;
+  }
+
+  void collect(size_t id, const std::string& tag) {
+    for (auto& error : state_->errors.drain()) {
+      if (id != 0 && error.submission == id) {
+        error.tag = tag;
+      }
+      errors_.push_back(std::move(error));
+    }
+  }
+
+  std::shared_ptr<state> state_;
+  duration defaultTimeout_;
+  size_t submissions_ = 0;
+  std::list<submission> inFlight_;
+  std::vector<async_error> errors_;
+};
+
+}  // namespace cppcon
+
+#endif  // __ASYNC_ERRORS_H__
@@ -0,0 +1,81 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __ASYNC_RESULT_H__
+#define __ASYNC_RESULT_H__
+
+#include <memory>
+#include <utility>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* A future-like handle to work which has been submitted to a queue. It owns
+ * whatever resources the work needs, such as buffers, until the work has
+ * completed, so that the function which submitted the work can return
+ * without blocking.
+ *
+ * Like a std::future returned by std::async, destroying an async_result which
+ * has not been waited on blocks until the work is complete. Any buffers
+ * constructed from host pointers are released in wait, so their data has been
+ * written back to the host by the time it returns. */
+class async_result {
+ public:
+  async_result() = default;
+
+  async_result(cl::sycl::event event, std::shared_ptr<void> resources)
+      : event_{std::move(event)}, resources_{std::move(resources)} {}
+
+  async_result(const async_result&) = delete;
+  async_result& operator=(const async_result&) = delete;
+
+  async_result(async_result&& other) = default;
+
+  async_result& operator=(async_result&& other) {
+    wait();
+    event_ = std::move(other.event_);
+    resources_ = std::move(other.resources_);
+    return *this;
+  }
+
+  /* Errors are not rethrown from the destructor, call wait to observe them. */
+  ~async_result() {
+    if (resources_) {
+      event_.wait();
+    }
+  }
+
+  /* Returns true if the work has not yet been waited on. */
+  bool valid() const noexcept { return resources_ != nullptr; }
+
+  bool is_ready() const {
+    return !valid() ||
+           event_.get_info<cl::sycl::info::event::command_execution_status>() ==
+               cl::sycl::info::event_command_status::complete;
+  }
+
+  void wait() {
+    if (resources_) {
+      event_.wait_and_throw();
+      resources_.reset();
+    }
+  }
+
+  cl::sycl::event get_event() const { return event_; }
+
+ private:
+  cl::sycl::event event_;
+  std::shared_ptr<void> resources_;
+};
+
+}  // namespace cppcon
+
+#endif  // __ASYNC_RESULT_H__
@@ -0,0 +1,240 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __AUTOTUNE_H__
+#define __AUTOTUNE_H__
+
+#include <keyed_cache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* Returns true if the local range can legally be used to launch a kernel over
+ * the global range on a device with the given limits, taking into account the
+ * maximum work-group size, the maximum work-item sizes per dimension, that the
+ * local range evenly divides the global range and that the local memory used
+ * per work-item fits in the local memory of the device. */
+template <int Dims, typename WorkItemSizes>
+bool is_valid_work_group_size(size_t maxWorkGroupSize,
+                              const WorkItemSizes& maxWorkItemSizes,
+                              size_t localMemSize,
+                              cl::sycl::range<Dims> globalRange,
+                              cl::sycl::range<Dims> localRange,
+                              size_t localMemPerWorkItem = 0) {
+  size_t workGroupSize = 1;
+  for (int d = 0; d < Dims; ++d) {
+    if (localRange[d] == 0 || localRange[d] > maxWorkItemSizes[d] ||
+        globalRange[d] % localRange[d] != 0) {
+      return false;
+    }
+    workGroupSize *= localRange[d];
+  }
+
+  return workGroupSize <= maxWorkGroupSize &&
+         workGroupSize * localMemPerWorkItem <= localMemSize;
+}
+
+/* The same, querying the limits of the device. */
+template <int Dims>
+bool is_valid_work_group_size(const cl::sycl::device& dev,
+                              cl::sycl::range<Dims> globalRange,
+                              cl::sycl::range<Dims> localRange,
+                              size_t localMemPerWorkItem = 0) {
+  return is_valid_work_group_size(
+      dev.get_info<cl::sycl::info::device::max_work_group_size>(),
+      dev.get_info<cl::sycl::info::device::max_work_item_sizes>(),
+      dev.get_info<cl::sycl::info::device::local_mem_size>(), globalRange,
+      localRange, localMemPerWorkItem);
+}
+
+/* Enumerates the power-of-two local ranges which are valid for the global
+ * range on the device, optionally filtered by a predicate, for example to only
+ * consider square work-groups. */
+template <int Dims>
+std::vector<cl::sycl::range<Dims>> work_group_candidates(
+    const cl::sycl::device& dev, cl::sycl::range<Dims> globalRange,
+    size_t localMemPerWorkItem = 0,
+    std::function<bool(cl::sycl::range<Dims>)> filter = nullptr) {
+  std::vector<cl::sycl::range<Dims>> candidates;
+
+  const auto maxWorkGroupSize =
+      dev.get_info<cl::sycl::info::device::max_work_group_size>();
+
+  auto candidate = cl::sycl::range<Dims>{globalRange};
+  for (int d = 0; d < Dims; ++d) {
+    candidate[d] = 1;
+  }
+
+  /* Odometer-style walk over every combination of powers of two. */
+  while (true) {
+    if (is_valid_work_group_size(dev, globalRange, candidate,
+                                 localMemPerWorkItem) &&
+        (!filter || filter(candidate))) {
+      candidates.push_back(candidate);
+    }
+
+    int d = 0;
+    for (; d < Dims; ++d) {
+      candidate[d] *= 2;
+      if (candidate[d] <= std::min(globalRange[d], maxWorkGroupSize)) {
+        break;
+      }
+      candidate[d] = 1;
+    }
+    if (d == Dims) {
+      break;
+    }
+  }
+
+  return candidates;
+}
+
+/* An on-disk keyed_cache of the best local range found for each combination
+ * of device, driver, kernel and problem size class. The file can be relocated
+ * using the SYCL_ACADEMY_TUNING_CACHE environment variable. */
+class work_group_cache {
+ public:
+  explicit work_group_cache(std::string path = default_path())
+      : cache_{std::move(path)} {}
+
+  static std::string default_path() {
+    return cache_path("SYCL_ACADEMY_TUNING_CACHE",
+                      "sycl_academy_work_group_sizes.txt");
+  }
+
+  template <int Dims>
+  static std::string key(const cl::sycl::device& dev,
+                         const std::string& kernelName,
+                         cl::sycl::range<Dims> globalRange) {
+    std::ostringstream key;
+    key << dev.get_info<cl::sycl::info::device::name>() << "|"
+        << dev.get_info<cl::sycl::info::device::driver_version>() << "|"
+        << kernelName << "|" << size_class(globalRange);
+    return key.str();
+  }
+
+  /* Problem sizes are bucketed by rounding each dimension up to the next power
+   * of two, so that similar sizes share a single tuning result. */
+  template <int Dims>
+  static std::string size_class(cl::sycl::range<Dims> globalRange) {
+    std::ostringstream sizeClass;
+    for (int d = 0; d < Dims; ++d) {
+      size_t bucket = 1;
+      while (bucket < globalRange[d]) {
+        bucket *= 2;
+      }
+      sizeClass << (d ? "x" : "") << bucket;
+    }
+    return sizeClass.str();
+  }
+
+  template <int Dims>
+  bool lookup(const std::string& key, cl::sycl::range<Dims>& localRange) const {
+    std::string value;
+    if (!cache_.lookup(key, value)) {
+      return false;
+    }
+    std::istringstream sizes(value);
+    std::vector<size_t> localSizes;
+    size_t size;
+    while (sizes >> size) {
+      localSizes.push_back(size);
+    }
+    if (localSizes.size() != Dims) {
+      return false;
+    }
+    for (int d = 0; d < Dims; ++d) {
+      localRange[d] = localSizes[d];
+    }
+    return true;
+  }
+
+  template <int Dims>
+  void store(const std::string& key, cl::sycl::range<Dims> localRange) {
+    std::ostringstream sizes;
+    for (int d = 0; d < Dims; ++d) {
+      sizes << localRange[d] << " ";
+    }
+    cache_.store(key, sizes.str());
+  }
+
+  const std::string& path() const noexcept { return cache_.path(); }
+
+ private:
+  keyed_cache cache_;
+};
+
+/* Returns the fastest local range for launching a kernel over the global range
+ * on the queue's device. On first use every valid candidate is benchmarked by
+ * calling launch, which must submit the kernel with the nd_range it is given
+ * and wait for it to complete; the winner is then stored in the cache so later
+ * runs can skip straight to the result. */
+template <int Dims, typename LaunchFunc>
+cl::sycl::range<Dims> autotune_work_group_size(
+    cl::sycl::queue& queue, const std::string& kernelName,
+    cl::sycl::range<Dims> globalRange, LaunchFunc&& launch,
+    size_t localMemPerWorkItem = 0,
+    std::function<bool(cl::sycl::range<Dims>)> filter = nullptr,
+    int iterations = 10, work_group_cache cache = work_group_cache{}) {
+  auto dev = queue.get_device();
+  auto key = work_group_cache::key(dev, kernelName, globalRange);
+
+  auto best = cl::sycl::range<Dims>{globalRange};
+  if (cache.lookup(key, best) &&
+      is_valid_work_group_size(dev, globalRange, best, localMemPerWorkItem)) {
+    return best;
+  }
+
+  auto bestTime = std::chrono::duration<double, std::milli>::max();
+  for (auto candidate : work_group_candidates(dev, globalRange,
+                                              localMemPerWorkItem, filter)) {
+    auto ndRange = cl::sycl::nd_range<Dims>(globalRange, candidate);
+    try {
+      /* The first launch is not timed as it may include kernel compilation. */
+      launch(ndRange);
+
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i) {
+        launch(ndRange);
+      }
+      auto end = std::chrono::steady_clock::now();
+
+      std::chrono::duration<double, std::milli> time = (end - start);
+      if (time < bestTime) {
+        bestTime = time;
+        best = candidate;
+      }
+    } catch (const cl::sycl::exception&) {
+      /* Some devices reject shapes which pass the queried limits, for example
+       * because of per-kernel register usage, so just skip them. */
+    }
+  }
+
+  if (bestTime == std::chrono::duration<double, std::milli>::max()) {
+    throw std::runtime_error("No valid work-group size found for " +
+                             kernelName);
+  }
+
+  cache.store(key, best);
+  return best;
+}
+
+}  // namespace cppcon
+
+#endif  // __AUTOTUNE_H__
@@ -14,11 +14,15 @@
 #define __BENCHMARK_H__
 
 #include <chrono>
+#include <iomanip>
 #include <iostream>
 #include <numeric>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include <memory_footprint.h>
+
 namespace cppcon {
 
 template <typename Unit>
@@ -66,12 +70,19 @@ void init_data(std::vector<ValueType> &vec, InitFunc initFunc) {
   }
 }
 
+/* The memory footprint of the last call to benchmark on this thread. */
+inline memory_footprint &last_footprint() {
+  thread_local memory_footprint footprint;
+  return footprint;
+}
+
 template <typename Func>
 auto benchmark(Func &&func, int iterations, std::string caption) {
   std::cout << caption << " (" << iterations << " iterations) \n";
   unsigned completion = 0;
   std::cout << "[";
   std::chrono::duration<double, std::milli> totalTime{0};
+  footprint_probe probe;
   for (int i = 0; i < iterations; i++) {
     std::chrono::steady_clock::time_point start =
         std::chrono::steady_clock::now();
@@ -88,13 +99,51 @@ auto benchmark(Func &&func, int iterations, std::string caption) {
   }
   std::cout << "]\n";
   auto averageTime = totalTime / iterations;
+  last_footprint() = probe.finish();
 
   std::cout << ": " << averageTime.count()
-            << unit_extension_v<std::milli> << "\n\n";
+            << unit_extension_v<std::milli> << "\n"
+            << last_footprint() << "\n\n";
 
   return averageTime;
 }
 
+/* The name and average time of a benchmark, and by default the memory
+ * footprint of the last benchmark run on this thread, so that
+ *   results.emplace_back(name, cppcon::benchmark(...));
+ * records the footprint of the benchmark timed. */
+struct benchmark_result {
+  benchmark_result(std::string name,
+                   std::chrono::duration<double, std::milli> time,
+                   memory_footprint footprint = last_footprint())
+      : name{std::move(name)}, time{time}, memory{footprint} {}
+
+  std::string name;
+  std::chrono::duration<double, std::milli> time;
+  memory_footprint memory;
+};
+
+/* Prints the average times returned by benchmark side-by-side, along with the
+ * speedup of each relative to the first result, which is taken as the
+ * baseline, and the peak host and tracked memory of each. */
+inline void print_comparison(const std::vector<benchmark_result> &results,
+                             std::string caption) {
+  std::cout << caption << "\n";
+  for (const auto &result : results) {
+    std::cout << "  " << std::left << std::setw(24) << result.name
+              << std::right << std::setw(12) << result.time.count()
+              << unit_extension_v<std::milli> << std::setw(10)
+              << (results.front().time / result.time) << "x"
+              << std::setw(12) << format_bytes(result.memory.peakRss);
+    if (result.memory.peakTracked > 0) {
+      std::cout << std::setw(12) << format_bytes(result.memory.peakTracked)
+                << " tracked";
+    }
+    std::cout << "\n";
+  }
+  std::cout << "\n";
+}
+
 void print(const std::vector<int> &vec, std::string tag) {
   std::cout << tag << ": ";
   for (auto e : vec) {
@@ -0,0 +1,389 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __CHROME_TRACE_H__
+#define __CHROME_TRACE_H__
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+/* A timeline of what the host and the device did, written in the Chrome
+ * trace-event format, which chrome://tracing and https://ui.perfetto.dev
+ * display, so that it's visible whether copies and kernels overlap and where
+ * the host waits.
+ *
+ * Host spans, such as submitting a command group, creating an accessor or
+ * waiting, are timed on the host, one track per host thread. Device spans,
+ * the copies, fills and kernels, are taken from the profiling information of
+ * the events of submissions made through a traced_queue, one track per queue.
+ * Device timestamps are placed on the host's timeline relative to the time
+ * of submission, as the device's clock has its own epoch.
+ *
+ * Tracing is enabled by setting the SYCL_ACADEMY_TRACE environment variable
+ * to anything other than 0, in which case each trace_timeline is written to
+ * <name>.json in the working directory when it's destroyed. Otherwise
+ * nothing is recorded, and a traced_queue doesn't enable profiling. */
+
+namespace cppcon {
+
+/* A complete event, "ph": "X", of the trace-event format. */
+struct trace_span {
+  std::string name;
+  std::string category;
+  int pid;
+  int tid;
+  double startUs;
+  double durationUs;
+};
+
+class trace_timeline {
+ public:
+  static constexpr int host_pid = 1;
+  static constexpr int device_pid = 2;
+
+  /* Records if SYCL_ACADEMY_TRACE is set, to <name>.json. */
+  explicit trace_timeline(std::string name)
+      : trace_timeline{std::move(name), tracing_requested()} {}
+
+  trace_timeline(std::string name, bool enabled)
+      : path_{name + ".json"},
+        enabled_{enabled},
+        epoch_{std::chrono::steady_clock::now()} {}
+
+  trace_timeline(const trace_timeline&) = delete;
+  trace_timeline& operator=(const trace_timeline&) = delete;
+
+  ~trace_timeline() {
+    if (enabled_ && !saved_) {
+      save();
+    }
+  }
+
+  static bool tracing_requested() {
+    const char* flag = std::getenv("SYCL_ACADEMY_TRACE");
+    return flag && *flag && std::string(flag) != "0";
+  }
+
+  bool enabled() const noexcept { return enabled_; }
+
+  const std::string& path() const noexcept { return path_; }
+
+  void set_path(std::string path) { path_ = std::move(path); }
+
+  /* Microseconds since the timeline was created. */
+  double now_us() const { return to_us(std::chrono::steady_clock::now()); }
+
+  double to_us(std::chrono::steady_clock::time_point time) const {
+    return std::chrono::duration<double, std::micro>(time - epoch_).count();
+  }
+
+  /* The track of the calling thread, named "host thread <n>" in order of
+   * first use. */
+  int thread_track() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto id = std::this_thread::get_id();
+    auto track = threadTracks_.find(id);
+    if (track == threadTracks_.end()) {
+      const int tid = static_cast<int>(threadTracks_.size()) + 1;
+      track = threadTracks_.emplace(id, tid).first;
+      trackNames_.emplace_back(host_pid, tid,
+                               "host thread " + std::to_string(tid));
+    }
+    return track->second;
+  }
+
+  /* A new device track, for a queue. */
+  int queue_track(std::string name) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    const int tid = ++queueTracks_;
+    trackNames_.emplace_back(device_pid, tid, std::move(name));
+    return tid;
+  }
+
+  void add(trace_span span) {
+    if (!enabled_) {
+      return;
+    }
+    std::lock_guard<std::mutex> lock{mutex_};
+    spans_.push_back(std::move(span));
+  }
+
+  /* Times the host from construction to destruction, on the track of the
+   * thread which constructed it. */
+  class scoped_span {
+   public:
+    scoped_span(trace_timeline& timeline, std::string name,
+                std::string category)
+        : timeline_{timeline.enabled() ? &timeline : nullptr} {
+      if (timeline_) {
+        span_ = trace_span{std::move(name), std::move(category), host_pid,
+                           timeline.thread_track(), timeline.now_us(), 0.0};
+      }
+    }
+
+    scoped_span(const scoped_span&) = delete;
+    scoped_span& operator=(const scoped_span&) = delete;
+
+    ~scoped_span() {
+      if (timeline_) {
+        span_.durationUs = timeline_->now_us() - span_.startUs;
+        timeline_->add(std::move(span_));
+      }
+    }
+
+   private:
+    trace_timeline* timeline_;
+    trace_span span_;
+  };
+
+  scoped_span span(std::string name, std::string category = "host") {
+    return scoped_span{*this, std::move(name), std::move(category)};
+  }
+
+  std::vector<trace_span> spans() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return spans_;
+  }
+
+  void write_json(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    /* Timestamps in microseconds, to the nanosecond. */
+    const auto flags = os.flags();
+    const auto precision = os.precision(3);
+    os << std::fixed;
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    os << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << host_pid
+       << ",\"tid\":0,\"args\":{\"name\":\"host\"}},\n";
+    os << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << device_pid
+       << ",\"tid\":0,\"args\":{\"name\":\"device\"}}";
+    for (const auto& track : trackNames_) {
+      os << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":"
+         << std::get<0>(track) << ",\"tid\":" << std::get<1>(track)
+         << ",\"args\":{\"name\":" << quote(std::get<2>(track)) << "}}";
+    }
+    for (const auto& span : spans_) {
+      os << ",\n{\"ph\":\"X\",\"name\":" << quote(span.name)
+         << ",\"cat\":" << quote(span.category) << ",\"pid\":" << span.pid
+         << ",\"tid\":" << span.tid << ",\"ts\":" << span.startUs
+         << ",\"dur\":" << span.durationUs << "}";
+    }
+    os << "\n]}\n";
+    os.flags(flags);
+    os.precision(precision);
+  }
+
+  /* Writes the timeline to path(), returning whether it succeeded. */
+  bool save() {
+    std::ofstream file{path_};
+    write_json(file);
+    saved_ = static_cast<bool>(file);
+    return saved_;
+  }
+
+ private:
+  static std::string quote(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+      if (c == '"' || c == '\\') {
+        quoted += '\\';
+        quoted += c;
+      } else if (static_cast<unsigned char>(c) < 0x20) {
+        char escaped[8];
+        std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        quoted += escaped;
+      } else {
+        quoted += c;
+      }
+    }
+    return quoted + "\"";
+  }
+
+  std::string path_;
+  bool enabled_;
+  bool saved_ = false;
+  std::chrono::steady_clock::time_point epoch_;
+  mutable std::mutex mutex_;
+  std::vector<trace_span> spans_;
+  std::map<std::thread::id, int> threadTracks_;
+  int queueTracks_ = 0;
+  std::vector<std::tuple<int, int, std::string>> trackNames_;
+};
+
+/* A queue whose submissions are traced on a trace_timeline: submitting and
+ * waiting as host spans, and the commands themselves as device spans, which
+ * are collected from the profiling information of their events once they
+ * complete, by wait or collect. When the timeline isn't enabled it's a plain
+ * queue, without profiling. */
+class traced_queue {
+ public:
+  traced_queue(trace_timeline& timeline, const cl::sycl::device& dev,
+               std::string name)
+      : timeline_{timeline},
+        queue_{timeline.enabled()
+                   ? cl::sycl::queue{dev,
+                                     cl::sycl::property_list{
+                                         cl::sycl::property::queue::
+                                             enable_profiling{}}}
+                   : cl::sycl::queue{dev}},
+        track_{timeline.enabled() ? timeline.queue_track(std::move(name))
+                                  : 0} {}
+
+  cl::sycl::queue& get_queue() noexcept { return queue_; }
+
+  /* category names the device span: "kernel", "copy" or "fill". */
+  template <typename CommandGroup>
+  cl::sycl::event submit(const std::string& name, CommandGroup&& cgf,
+                         std::string category = "kernel") {
+    if (!timeline_.enabled()) {
+      return queue_.submit(std::forward<CommandGroup>(cgf));
+    }
+
+    const auto submitted = std::chrono::steady_clock::now();
+    cl::sycl::event event;
+    {
+      auto span = timeline_.span("submit " + name, "submit");
+      event = queue_.submit(std::forward<CommandGroup>(cgf));
+    }
+    std::lock_guard<std::mutex> lock{mutex_};
+    pending_.push_back(
+        submission{name, std::move(category), event, submitted});
+    return event;
+  }
+
+  /* Copies between USM allocations or host memory, as a "copy" span, once
+   * deps complete. The command groups of memcpy and fill are generic so that
+   * the USM commands, which SYCL 1.2.1 handlers lack, are only instantiated
+   * where they're used. */
+  template <typename T>
+  cl::sycl::event memcpy(const std::string& name, T* dest, const T* src,
+                         size_t count,
+                         const std::vector<cl::sycl::event>& deps = {}) {
+    return submit(
+        name,
+        [&](auto& cgh) {
+          for (auto& dep : deps) {
+            cgh.depends_on(dep);
+          }
+          cgh.memcpy(dest, src, count * sizeof(T));
+        },
+        "copy");
+  }
+
+  template <typename T>
+  cl::sycl::event fill(const std::string& name, T* ptr, const T& value,
+                       size_t count,
+                       const std::vector<cl::sycl::event>& deps = {}) {
+    return submit(
+        name,
+        [&](auto& cgh) {
+          for (auto& dep : deps) {
+            cgh.depends_on(dep);
+          }
+          cgh.fill(ptr, value, count);
+        },
+        "fill");
+  }
+
+  /* Creates an accessor within a command group, as an "accessor" span. */
+  template <cl::sycl::access::mode Mode, typename Buffer>
+  auto get_access(cl::sycl::handler& cgh, Buffer& buf,
+                  const std::string& name = "accessor") {
+    auto span = timeline_.span(name, "accessor");
+    return buf.template get_access<Mode>(cgh);
+  }
+
+  /* Waits for every submission, as a "wait" span, and collects them. */
+  void wait() {
+    {
+      auto span = timeline_.span("wait", "wait");
+      queue_.wait_and_throw();
+    }
+    collect();
+  }
+
+  /* Adds the device spans of the submissions which have completed. */
+  void collect() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto first = pending_.begin();
+    while (first != pending_.end()) {
+      const auto status =
+          first->event
+              .get_info<cl::sycl::info::event::command_execution_status>();
+      if (status != cl::sycl::info::event_command_status::complete) {
+        ++first;
+        continue;
+      }
+      add_device_span(*first);
+      first = pending_.erase(first);
+    }
+  }
+
+ private:
+  struct submission {
+    std::string name;
+    std::string category;
+    cl::sycl::event event;
+    std::chrono::steady_clock::time_point submitted;
+  };
+
+  /* The device clock is mapped onto the timeline by one offset per queue,
+   * taken from the host and device submit times of the first command
+   * collected, so that the device spans keep their positions relative to
+   * each other, and show whether copies and kernels overlap. The device's
+   * submit time of a later command can't anchor that command itself, as it
+   * is when the runtime's scheduler submitted it, once its dependencies were
+   * resolved, not when it was submitted on the host. */
+  void add_device_span(const submission& s) {
+    using namespace cl::sycl::info;
+    const auto startNs =
+        s.event.get_profiling_info<event_profiling::command_start>();
+    const auto endNs =
+        s.event.get_profiling_info<event_profiling::command_end>();
+
+    if (!clockOffsetUs_) {
+      const auto submitNs =
+          s.event.get_profiling_info<event_profiling::command_submit>();
+      clockOffsetUs_ = timeline_.to_us(s.submitted) -
+                       static_cast<double>(submitNs) / 1000.0;
+    }
+
+    const double startUs = static_cast<double>(startNs) / 1000.0 +
+                           *clockOffsetUs_;
+    timeline_.add(trace_span{s.name, s.category, trace_timeline::device_pid,
+                             track_, startUs,
+                             static_cast<double>(endNs - startNs) / 1000.0});
+  }
+
+  trace_timeline& timeline_;
+  cl::sycl::queue queue_;
+  int track_;
+  std::mutex mutex_;
+  std::vector<submission> pending_;
+  std::optional<double> clockOffsetUs_;
+};
+
+}  // namespace cppcon
+
+#endif  // __CHROME_TRACE_H__
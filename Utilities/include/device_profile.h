@@ -0,0 +1,387 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __DEVICE_PROFILE_H__
+#define __DEVICE_PROFILE_H__
+
+#include <autotune.h>
+
+#include <algorithm>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+/* Sub-group sizes can only be queried where SYCL 2020 sub-groups are
+ * supported, which DPC++ does; define this to query them elsewhere. */
+#if !defined(SYCL_ACADEMY_HAS_SUB_GROUP_SIZES) && \
+    (defined(__INTEL_LLVM_COMPILER) || defined(__SYCL_COMPILER_VERSION))
+#define SYCL_ACADEMY_HAS_SUB_GROUP_SIZES
+#endif
+
+namespace cppcon {
+
+/* Preferred or native vector widths per element type, 0 if the type isn't
+ * supported, for example double on many GPUs. */
+struct vector_widths {
+  unsigned charWidth = 0;
+  unsigned shortWidth = 0;
+  unsigned intWidth = 0;
+  unsigned longWidth = 0;
+  unsigned floatWidth = 0;
+  unsigned doubleWidth = 0;
+  unsigned halfWidth = 0;
+
+  template <typename T>
+  unsigned get() const noexcept {
+    switch (sizeof(T)) {
+      case 1:
+        return charWidth;
+      case 2:
+        return std::is_integral<T>::value ? shortWidth : halfWidth;
+      case 4:
+        return std::is_integral<T>::value ? intWidth : floatWidth;
+      default:
+        return std::is_integral<T>::value ? longWidth : doubleWidth;
+    }
+  }
+};
+
+/* The limits and topology of a device which matter when choosing the shape
+ * of a kernel, queried once by device_profile::get and then cached for the
+ * lifetime of the process, as each get_info call can be a driver call. */
+struct device_profile {
+  std::string name;
+  std::string vendor;
+  std::string driverVersion;
+  std::string deviceType;
+
+  unsigned computeUnits = 0;
+  unsigned maxClockFrequencyMHz = 0;
+
+  size_t maxWorkGroupSize = 0;
+  std::array<size_t, 3> maxWorkItemSizes{};
+  std::vector<size_t> subGroupSizes;
+
+  size_t localMemSize = 0;
+  /* False if local memory is emulated in global memory, as on most CPUs, in
+   * which case staging data through it is rarely worthwhile. */
+  bool dedicatedLocalMem = false;
+
+  size_t globalMemSize = 0;
+  size_t maxMemAllocSize = 0;
+  size_t globalMemCacheLineSize = 0;
+  size_t globalMemCacheSize = 0;
+  std::string globalMemCacheType;
+
+  vector_widths preferredVectorWidths;
+  vector_widths nativeVectorWidths;
+
+  bool usmDeviceAllocations = false;
+  bool usmHostAllocations = false;
+  bool usmSharedAllocations = false;
+
+  /* Returns the cached profile of dev, querying it on first use. Devices are
+   * compared rather than keyed by name, as sub-devices share their parent's
+   * name but not its compute units. */
+  static const device_profile& get(const cl::sycl::device& dev) {
+    static std::mutex mutex;
+    static std::deque<std::pair<cl::sycl::device, device_profile>> profiles;
+
+    std::lock_guard<std::mutex> lock{mutex};
+    for (const auto& profile : profiles) {
+      if (profile.first == dev) {
+        return profile.second;
+      }
+    }
+    profiles.emplace_back(dev, query(dev));
+    return profiles.back().second;
+  }
+
+  /* Queries dev, bypassing the cache. */
+  static device_profile query(const cl::sycl::device& dev) {
+    namespace info = cl::sycl::info;
+
+    device_profile profile;
+    profile.name = dev.get_info<info::device::name>();
+    profile.vendor = dev.get_info<info::device::vendor>();
+    profile.driverVersion = dev.get_info<info::device::driver_version>();
+    profile.deviceType = dev.is_host()          ? "host"
+                         : dev.is_cpu()         ? "cpu"
+                         : dev.is_gpu()         ? "gpu"
+                         : dev.is_accelerator() ? "accelerator"
+                                                : "custom";
+
+    profile.computeUnits = dev.get_info<info::device::max_compute_units>();
+    profile.maxClockFrequencyMHz =
+        dev.get_info<info::device::max_clock_frequency>();
+
+    profile.maxWorkGroupSize =
+        dev.get_info<info::device::max_work_group_size>();
+    const auto maxWorkItemSizes =
+        dev.get_info<info::device::max_work_item_sizes>();
+    for (int d = 0; d < 3; ++d) {
+      profile.maxWorkItemSizes[d] = maxWorkItemSizes[d];
+    }
+#ifdef SYCL_ACADEMY_HAS_SUB_GROUP_SIZES
+    for (auto size : dev.get_info<info::device::sub_group_sizes>()) {
+      profile.subGroupSizes.push_back(size);
+    }
+#endif  // SYCL_ACADEMY_HAS_SUB_GROUP_SIZES
+
+    profile.localMemSize = dev.get_info<info::device::local_mem_size>();
+    profile.dedicatedLocalMem = dev.get_info<info::device::local_mem_type>() ==
+                                info::local_mem_type::local;
+
+    profile.globalMemSize = dev.get_info<info::device::global_mem_size>();
+    profile.maxMemAllocSize = dev.get_info<info::device::max_mem_alloc_size>();
+    profile.globalMemCacheLineSize =
+        dev.get_info<info::device::global_mem_cache_line_size>();
+    profile.globalMemCacheSize =
+        dev.get_info<info::device::global_mem_cache_size>();
+    switch (dev.get_info<info::device::global_mem_cache_type>()) {
+      case info::global_mem_cache_type::read_only:
+        profile.globalMemCacheType = "read_only";
+        break;
+      case info::global_mem_cache_type::read_write:
+        profile.globalMemCacheType = "read_write";
+        break;
+      default:
+        profile.globalMemCacheType = "none";
+    }
+
+    auto& preferred = profile.preferredVectorWidths;
+    preferred.charWidth =
+        dev.get_info<info::device::preferred_vector_width_char>();
+    preferred.shortWidth =
+        dev.get_info<info::device::preferred_vector_width_short>();
+    preferred.intWidth =
+        dev.get_info<info::device::preferred_vector_width_int>();
+    preferred.longWidth =
+        dev.get_info<info::device::preferred_vector_width_long>();
+    preferred.floatWidth =
+        dev.get_info<info::device::preferred_vector_width_float>();
+    preferred.doubleWidth =
+        dev.get_info<info::device::preferred_vector_width_double>();
+    preferred.halfWidth =
+        dev.get_info<info::device::preferred_vector_width_half>();
+
+    auto& native = profile.nativeVectorWidths;
+    native.charWidth = dev.get_info<info::device::native_vector_width_char>();
+    native.shortWidth = dev.get_info<info::device::native_vector_width_short>();
+    native.intWidth = dev.get_info<info::device::native_vector_width_int>();
+    native.longWidth = dev.get_info<info::device::native_vector_width_long>();
+    native.floatWidth = dev.get_info<info::device::native_vector_width_float>();
+    native.doubleWidth =
+        dev.get_info<info::device::native_vector_width_double>();
+    native.halfWidth = dev.get_info<info::device::native_vector_width_half>();
+
+    profile.usmDeviceAllocations =
+        dev.get_info<info::device::usm_device_allocations>();
+    profile.usmHostAllocations =
+        dev.get_info<info::device::usm_host_allocations>();
+    profile.usmSharedAllocations =
+        dev.get_info<info::device::usm_shared_allocations>();
+
+    return profile;
+  }
+
+  /* is_valid_work_group_size against the cached limits. */
+  template <int Dims>
+  bool is_valid_local_range(cl::sycl::range<Dims> globalRange,
+                            cl::sycl::range<Dims> localRange,
+                            size_t localMemPerWorkItem = 0) const {
+    return is_valid_work_group_size(maxWorkGroupSize, maxWorkItemSizes,
+                                    localMemSize, globalRange, localRange,
+                                    localMemPerWorkItem);
+  }
+
+  /* The largest number of work-items in a work-group each using
+   * localMemPerWorkItem bytes of local memory. */
+  size_t max_work_group_size_for(size_t localMemPerWorkItem) const noexcept {
+    if (localMemPerWorkItem == 0) {
+      return maxWorkGroupSize;
+    }
+    return std::min(maxWorkGroupSize, localMemSize / localMemPerWorkItem);
+  }
+
+  /* A legal power-of-two local range for globalRange that is as large as the
+   * limits allow. Dimensions are doubled in turn, starting with the last, which
+   * is the contiguous one, so that 2D work-groups are square or as close to it
+   * as the global range allows, which suits tiled kernels such as the
+   * transpose in Exercise 6. A dimension stops growing once it no longer
+   * divides the global range, so prime sizes give a local range of 1; use
+   * padded_nd_range for those. */
+  template <int Dims>
+  cl::sycl::range<Dims> preferred_local_range(
+      cl::sycl::range<Dims> globalRange, size_t localMemPerWorkItem = 0) const {
+    return grow_local_range(globalRange, localMemPerWorkItem, true);
+  }
+
+  template <int Dims>
+  cl::sycl::nd_range<Dims> make_nd_range(
+      cl::sycl::range<Dims> globalRange, size_t localMemPerWorkItem = 0) const {
+    return cl::sycl::nd_range<Dims>(
+        globalRange, preferred_local_range(globalRange, localMemPerWorkItem));
+  }
+
+  /* An nd_range with the largest legal local range, and the global range
+   * rounded up to a multiple of it. The kernel must ignore work-items outside
+   * of the original global range. */
+  template <int Dims>
+  cl::sycl::nd_range<Dims> padded_nd_range(
+      cl::sycl::range<Dims> globalRange, size_t localMemPerWorkItem = 0) const {
+    auto localRange = grow_local_range(globalRange, localMemPerWorkItem, false);
+    auto paddedRange = globalRange;
+    for (int d = 0; d < Dims; ++d) {
+      paddedRange[d] =
+          ((globalRange[d] + localRange[d] - 1) / localRange[d]) * localRange[d];
+    }
+    return cl::sycl::nd_range<Dims>(paddedRange, localRange);
+  }
+
+  /* The vec width to use for elements of type T, a power of two from 1 to
+   * 16. The preferred width is the one the compiler vectorises well; the
+   * native width is that of the hardware's vector registers. */
+  template <typename T>
+  int vector_width(bool native = false) const noexcept {
+    const unsigned width = native ? nativeVectorWidths.get<T>()
+                                  : preferredVectorWidths.get<T>();
+    int result = 1;
+    while (result * 2 <= static_cast<int>(width) && result < 16) {
+      result *= 2;
+    }
+    return result;
+  }
+
+  /* The number of T which fit in a cache line. */
+  template <typename T>
+  size_t cache_line_elements() const noexcept {
+    return std::max<size_t>(1, globalMemCacheLineSize / sizeof(T));
+  }
+
+  std::string to_json() const {
+    std::ostringstream json;
+    json << "{\n"
+         << "  \"name\": " << quote(name) << ",\n"
+         << "  \"vendor\": " << quote(vendor) << ",\n"
+         << "  \"driver_version\": " << quote(driverVersion) << ",\n"
+         << "  \"device_type\": " << quote(deviceType) << ",\n"
+         << "  \"compute_units\": " << computeUnits << ",\n"
+         << "  \"max_clock_frequency_mhz\": " << maxClockFrequencyMHz << ",\n"
+         << "  \"max_work_group_size\": " << maxWorkGroupSize << ",\n"
+         << "  \"max_work_item_sizes\": [" << maxWorkItemSizes[0] << ", "
+         << maxWorkItemSizes[1] << ", " << maxWorkItemSizes[2] << "],\n"
+         << "  \"sub_group_sizes\": [";
+    for (size_t i = 0; i < subGroupSizes.size(); ++i) {
+      json << (i ? ", " : "") << subGroupSizes[i];
+    }
+    json << "],\n"
+         << "  \"local_mem_size\": " << localMemSize << ",\n"
+         << "  \"local_mem_type\": "
+         << quote(dedicatedLocalMem ? "local" : "global") << ",\n"
+         << "  \"global_mem_size\": " << globalMemSize << ",\n"
+         << "  \"max_mem_alloc_size\": " << maxMemAllocSize << ",\n"
+         << "  \"global_mem_cache_line_size\": " << globalMemCacheLineSize
+         << ",\n"
+         << "  \"global_mem_cache_size\": " << globalMemCacheSize << ",\n"
+         << "  \"global_mem_cache_type\": " << quote(globalMemCacheType)
+         << ",\n"
+         << "  \"preferred_vector_widths\": " << to_json(preferredVectorWidths)
+         << ",\n"
+         << "  \"native_vector_widths\": " << to_json(nativeVectorWidths)
+         << ",\n"
+         << "  \"usm\": {\"device\": " << to_json(usmDeviceAllocations)
+         << ", \"host\": " << to_json(usmHostAllocations)
+         << ", \"shared\": " << to_json(usmSharedAllocations) << "}\n"
+         << "}";
+    return json.str();
+  }
+
+ private:
+  template <int Dims>
+  cl::sycl::range<Dims> grow_local_range(cl::sycl::range<Dims> globalRange,
+                                         size_t localMemPerWorkItem,
+                                         bool divisible) const {
+    const size_t limit = max_work_group_size_for(localMemPerWorkItem);
+
+    auto localRange = globalRange;
+    for (int d = 0; d < Dims; ++d) {
+      localRange[d] = 1;
+    }
+
+    size_t workGroupSize = 1;
+    bool grown = true;
+    while (grown) {
+      grown = false;
+      for (int d = Dims - 1; d >= 0; --d) {
+        const size_t next = localRange[d] * 2;
+        const bool fits = divisible ? globalRange[d] % next == 0
+                                    : localRange[d] < globalRange[d];
+        if (fits && next <= maxWorkItemSizes[d] &&
+            workGroupSize * 2 <= limit) {
+          localRange[d] = next;
+          workGroupSize *= 2;
+          grown = true;
+        }
+      }
+    }
+    return localRange;
+  }
+
+  static std::string quote(const std::string& value) {
+    std::string quoted = "\"";
+    for (char c : value) {
+      switch (c) {
+        case '"':
+          quoted += "\\\"";
+          break;
+        case '\\':
+          quoted += "\\\\";
+          break;
+        case '\n':
+          quoted += "\\n";
+          break;
+        case '\t':
+          quoted += "\\t";
+          break;
+        default:
+          if (static_cast<unsigned char>(c) >= 0x20) {
+            quoted += c;
+          }
+      }
+    }
+    return quoted + "\"";
+  }
+
+  static std::string to_json(bool value) { return value ? "true" : "false"; }
+
+  static std::string to_json(const vector_widths& widths) {
+    std::ostringstream json;
+    json << "{\"char\": " << widths.charWidth
+         << ", \"short\": " << widths.shortWidth
+         << ", \"int\": " << widths.intWidth
+         << ", \"long\": " << widths.longWidth
+         << ", \"float\": " << widths.floatWidth
+         << ", \"double\": " << widths.doubleWidth
+         << ", \"half\": " << widths.halfWidth << "}";
+    return json.str();
+  }
+};
+
+}  // namespace cppcon
+
+#endif  // __DEVICE_PROFILE_H__
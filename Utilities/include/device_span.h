@@ -0,0 +1,120 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __DEVICE_SPAN_H__
+#define __DEVICE_SPAN_H__
+
+/* See usm_pointer.h for the includes required when using ComputeCpp. */
+#include <usm_pointer.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+#include <CL/sycl.hpp>
+
+/* Placed after the parameter list of a kernel lambda to tell the compiler that
+ * the pointers it captures don't alias, which device_span promises. Only DPC++
+ * has an attribute for this, elsewhere it expands to nothing. */
+#if defined(__INTEL_LLVM_COMPILER) || defined(__SYCL_COMPILER_VERSION)
+#define SYCL_ACADEMY_KERNEL_ARGS_RESTRICT [[intel::kernel_args_restrict]]
+#else
+#define SYCL_ACADEMY_KERNEL_ARGS_RESTRICT
+#endif
+
+namespace cppcon {
+
+/* A view of size elements of USM memory which can be captured by a SYCL
+ * kernel function, whether USM pointers must be wrapped in a usm_wrapper, as
+ * with ComputeCpp, or can be captured directly.
+ *
+ * The memory must be aligned to Alignment bytes, which is checked when the
+ * span is constructed, even with NDEBUG, and loads and stores tell the
+ * compiler about it where it can be told. A span also promises that, within a kernel, its memory isn't
+ * accessed through any other span or pointer, so kernels which only access
+ * memory through spans can be marked SYCL_ACADEMY_KERNEL_ARGS_RESTRICT.
+ *
+ * load and store move vec<T, N>s, which lets the compiler use vector loads of
+ * width N regardless of how it would have vectorised the kernel. For these to
+ * be aligned, Alignment should be a multiple of sizeof(vec<T, N>). */
+template <typename T, size_t Alignment = alignof(T)>
+class device_span {
+  static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+                "Alignment must be a power of two and at least alignof(T)");
+
+ public:
+  using element_type = T;
+  static constexpr size_t alignment = Alignment;
+
+  device_span() = default;
+
+  device_span(T* ptr, size_t size) : ptr_{ptr}, size_{size} {
+    if (reinterpret_cast<std::uintptr_t>(ptr) % Alignment != 0) {
+      throw std::invalid_argument("device_span: pointer is misaligned");
+    }
+  }
+
+  size_t size() const noexcept { return size_; }
+
+  T& operator[](size_t index) const { return data()[index]; }
+
+  /* Loads elements [index * N, index * N + N). */
+  template <int N>
+  cl::sycl::vec<T, N> load(size_t index) const {
+    cl::sycl::vec<T, N> result;
+    result.load(index, global_data());
+    return result;
+  }
+
+  /* Stores to elements [index * N, index * N + N). */
+  template <int N>
+  void store(size_t index, const cl::sycl::vec<T, N>& value) const {
+    value.store(index, global_data());
+  }
+
+ private:
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+  /* usm_wrapper can't be told about alignment. */
+  usm_pointer<T>& data() const { return ptr_; }
+
+  mutable usm_pointer<T> ptr_;
+#else
+  T* data() const {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<T*>(__builtin_assume_aligned(ptr_, Alignment));
+#else
+    return ptr_;
+#endif
+  }
+
+  T* ptr_ = nullptr;
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+  /* USM device allocations are in the global address space. */
+  cl::sycl::global_ptr<T> global_data() const {
+    return cl::sycl::global_ptr<T>{static_cast<T*>(data())};
+  }
+
+  size_t size_ = 0;
+};
+
+template <size_t Alignment, typename T>
+device_span<T, Alignment> make_device_span(T* ptr, size_t size) {
+  return device_span<T, Alignment>{ptr, size};
+}
+
+template <typename T>
+device_span<T> make_device_span(T* ptr, size_t size) {
+  return device_span<T>{ptr, size};
+}
+
+}  // namespace cppcon
+
+#endif  // __DEVICE_SPAN_H__
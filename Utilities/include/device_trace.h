@@ -0,0 +1,191 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __DEVICE_TRACE_H__
+#define __DEVICE_TRACE_H__
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* A fixed-size binary record appended by a work-item: a tag identifying what
+ * is being logged, the id of the work-item and up to N values. */
+template <typename T, int N>
+struct trace_record {
+  std::uint32_t tag;
+  std::uint32_t id;
+  T values[N];
+};
+
+/* The kernel side of a device_trace, captured by value in the kernel
+ * function. Appending a record takes a single atomic fetch-add on the record
+ * counter to claim a slot, followed by plain stores, so unlike
+ * cl::sycl::stream nothing is formatted, and nothing serialises work-items
+ * other than contention on the counter. */
+template <typename T, int N>
+class trace_writer {
+ public:
+  using records_accessor =
+      cl::sycl::accessor<trace_record<T, N>, 1, cl::sycl::access::mode::write>;
+  using counter_accessor =
+      cl::sycl::accessor<std::uint32_t, 1, cl::sycl::access::mode::atomic>;
+
+  trace_writer(records_accessor records, counter_accessor counter)
+      : records_{records}, counter_{counter} {}
+
+  template <typename... Values>
+  void log(std::uint32_t tag, size_t id, Values... values) const {
+    static_assert(sizeof...(Values) <= N, "too many values for the record");
+
+    const std::uint32_t slot = counter_[0].fetch_add(1u);
+    const std::uint32_t index = slot % records_.get_count();
+
+    const T packed[sizeof...(Values) + 1] = {static_cast<T>(values)..., T{}};
+    trace_record<T, N> record{tag, static_cast<std::uint32_t>(id), {}};
+    for (size_t v = 0; v < sizeof...(Values); ++v) {
+      record.values[v] = packed[v];
+    }
+    records_[index] = record;
+  }
+
+ private:
+  records_accessor records_;
+  counter_accessor counter_;
+};
+
+/* A ring buffer of trace_records which work-items append to while a kernel
+ * runs, and the host decodes and formats once it has completed. Get a
+ * trace_writer for each command group with get_writer.
+ *
+ * Once more records have been appended than the capacity, the oldest are
+ * overwritten. Records which wrap onto the same slot within a single kernel
+ * may interleave, so size the capacity for the records expected, and check
+ * dropped(). */
+template <typename T = int, int N = 2>
+class device_trace {
+ public:
+  using record = trace_record<T, N>;
+
+  explicit device_trace(size_t capacity)
+      : records_{cl::sycl::range<1>(capacity)},
+        counter_{cl::sycl::range<1>(1)} {
+    reset();
+  }
+
+  trace_writer<T, N> get_writer(cl::sycl::handler& cgh) {
+    return trace_writer<T, N>{
+        records_.template get_access<cl::sycl::access::mode::write>(cgh),
+        counter_.template get_access<cl::sycl::access::mode::atomic>(cgh)};
+  }
+
+  /* The format for records with tag. {id} is replaced by the work-item id
+   * and each {} by the next value. Records with no format are printed as the
+   * tag followed by the values. */
+  void set_format(std::uint32_t tag, std::string format) {
+    formats_[tag] = std::move(format);
+  }
+
+  size_t capacity() const { return records_.get_count(); }
+
+  /* The number of records appended since the last reset, including any which
+   * have been overwritten. These wait for any kernels writing to the trace. */
+  size_t count() {
+    auto counterAcc =
+        counter_.template get_access<cl::sycl::access::mode::read>();
+    return counterAcc[0];
+  }
+
+  size_t dropped() {
+    const auto appended = count();
+    return appended > capacity() ? appended - capacity() : 0;
+  }
+
+  /* The surviving records, oldest first. */
+  std::vector<record> records() {
+    const size_t appended = count();
+    const size_t size = std::min(appended, capacity());
+    const size_t first = appended > capacity() ? appended % capacity() : 0;
+
+    auto recordsAcc =
+        records_.template get_access<cl::sycl::access::mode::read>();
+    std::vector<record> result;
+    result.reserve(size);
+    for (size_t r = 0; r < size; ++r) {
+      result.push_back(recordsAcc[(first + r) % capacity()]);
+    }
+    return result;
+  }
+
+  void print(std::ostream& os) {
+    for (const auto& r : records()) {
+      os << format(r) << "\n";
+    }
+    if (const auto lost = dropped()) {
+      os << "(" << lost << " trace records dropped)\n";
+    }
+  }
+
+  std::string format(const record& r) const {
+    auto entry = formats_.find(r.tag);
+    if (entry == formats_.end()) {
+      std::string line = "[" + std::to_string(r.id) + "] tag " +
+                         std::to_string(r.tag) + ":";
+      for (int v = 0; v < N; ++v) {
+        line += " " + to_string(r.values[v]);
+      }
+      return line;
+    }
+
+    const auto& fmt = entry->second;
+    std::string line;
+    int v = 0;
+    for (size_t i = 0; i < fmt.size(); ++i) {
+      if (fmt.compare(i, 4, "{id}") == 0) {
+        line += std::to_string(r.id);
+        i += 3;
+      } else if (fmt.compare(i, 2, "{}") == 0 && v < N) {
+        line += to_string(r.values[v++]);
+        i += 1;
+      } else {
+        line += fmt[i];
+      }
+    }
+    return line;
+  }
+
+  void reset() {
+    auto counterAcc =
+        counter_.template get_access<cl::sycl::access::mode::discard_write>();
+    counterAcc[0] = 0;
+  }
+
+ private:
+  static std::string to_string(const T& value) {
+    std::ostringstream str;
+    str << value;
+    return str.str();
+  }
+
+  cl::sycl::buffer<record, 1> records_;
+  cl::sycl::buffer<std::uint32_t, 1> counter_;
+  std::map<std::uint32_t, std::string> formats_;
+};
+
+}  // namespace cppcon
+
+#endif  // __DEVICE_TRACE_H__
@@ -0,0 +1,296 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __DEVICE_VECTOR_H__
+#define __DEVICE_VECTOR_H__
+
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+/* A vector stored in a SYCL buffer whose elementwise arithmetic is lazy:
+ * expressions such as a + b + c or a * s + b build an expression tree at
+ * compile time, and assigning the tree to a device_vector evaluates it in a
+ * single fused parallel_for, without any intermediate buffers. */
+
+namespace cppcon {
+
+template <typename T>
+class device_vector;
+
+namespace expr {
+
+struct plus {
+  template <typename A, typename B>
+  auto operator()(A a, B b) const {
+    return a + b;
+  }
+};
+
+struct minus {
+  template <typename A, typename B>
+  auto operator()(A a, B b) const {
+    return a - b;
+  }
+};
+
+struct multiplies {
+  template <typename A, typename B>
+  auto operator()(A a, B b) const {
+    return a * b;
+  }
+};
+
+struct divides {
+  template <typename A, typename B>
+  auto operator()(A a, B b) const {
+    return a / b;
+  }
+};
+
+/* The leaves and nodes of the expression tree are held by value on the host.
+ * Calling bind inside a command group produces a matching tree of evaluators,
+ * in which each vector leaf is replaced with a read accessor, and which can
+ * be captured by the kernel. uses reports whether a buffer is read by the
+ * tree. */
+
+template <typename T>
+struct vector_eval {
+  using value_type = T;
+
+  cl::sycl::accessor<T, 1, cl::sycl::access::mode::read,
+                     cl::sycl::access::target::global_buffer>
+      acc;
+
+  T operator()(size_t i) const { return acc[i]; }
+};
+
+template <typename T>
+struct vector_leaf {
+  using value_type = T;
+
+  cl::sycl::buffer<T, 1> buf;
+
+  size_t size() const { return buf.get_count(); }
+
+  bool uses(const cl::sycl::buffer<T, 1>& other) const { return buf == other; }
+
+  template <typename U>
+  bool uses(const cl::sycl::buffer<U, 1>&) const {
+    return false;
+  }
+
+  vector_eval<T> bind(cl::sycl::handler& cgh) const {
+    auto b = buf;
+    return {b.template get_access<cl::sycl::access::mode::read>(cgh)};
+  }
+};
+
+template <typename T>
+struct scalar_leaf {
+  using value_type = T;
+
+  T value;
+
+  size_t size() const { return 0; }
+
+  template <typename U>
+  bool uses(const cl::sycl::buffer<U, 1>&) const {
+    return false;
+  }
+
+  scalar_leaf bind(cl::sycl::handler&) const { return *this; }
+
+  T operator()(size_t) const { return value; }
+};
+
+template <typename Op, typename Lhs, typename Rhs>
+struct binary_node {
+  using value_type = decltype(Op{}(std::declval<typename Lhs::value_type>(),
+                                   std::declval<typename Rhs::value_type>()));
+
+  Lhs lhs;
+  Rhs rhs;
+
+  /* Scalars report a size of zero so the vector operand determines it. */
+  size_t size() const {
+    if (lhs.size() != 0 && rhs.size() != 0 && lhs.size() != rhs.size()) {
+      throw std::invalid_argument("device_vector: operands differ in size");
+    }
+    return lhs.size() ? lhs.size() : rhs.size();
+  }
+
+  template <typename U>
+  bool uses(const cl::sycl::buffer<U, 1>& other) const {
+    return lhs.uses(other) || rhs.uses(other);
+  }
+
+  auto bind(cl::sycl::handler& cgh) const {
+    return binary_node<Op, decltype(lhs.bind(cgh)), decltype(rhs.bind(cgh))>{
+        lhs.bind(cgh), rhs.bind(cgh)};
+  }
+
+  value_type operator()(size_t i) const { return Op{}(lhs(i), rhs(i)); }
+};
+
+template <typename T>
+struct is_expression : std::false_type {};
+
+template <typename T>
+struct is_expression<vector_leaf<T>> : std::true_type {};
+
+template <typename T>
+struct is_expression<scalar_leaf<T>> : std::true_type {};
+
+template <typename Op, typename Lhs, typename Rhs>
+struct is_expression<binary_node<Op, Lhs, Rhs>> : std::true_type {};
+
+template <typename T>
+struct is_expression<device_vector<T>> : std::true_type {};
+
+template <typename T>
+struct is_operand
+    : std::integral_constant<bool, is_expression<T>::value ||
+                                       std::is_arithmetic<T>::value> {};
+
+template <typename T>
+vector_leaf<T> as_expression(const device_vector<T>& v) {
+  return {v.get_buffer()};
+}
+
+template <typename T,
+          typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+scalar_leaf<T> as_expression(T value) {
+  return {value};
+}
+
+template <typename Op, typename Lhs, typename Rhs>
+binary_node<Op, Lhs, Rhs> as_expression(binary_node<Op, Lhs, Rhs> node) {
+  return node;
+}
+
+template <typename Op, typename Lhs, typename Rhs>
+using make_node = binary_node<
+    Op, decltype(as_expression(std::declval<const std::decay_t<Lhs>&>())),
+    decltype(as_expression(std::declval<const std::decay_t<Rhs>&>()))>;
+
+/* Only enabled when at least one operand is a vector or an expression, so that
+ * arithmetic on plain scalars is left alone. */
+template <typename Lhs, typename Rhs>
+using enable_if_operands = std::enable_if_t<
+    is_operand<std::decay_t<Lhs>>::value &&
+    is_operand<std::decay_t<Rhs>>::value &&
+    (is_expression<std::decay_t<Lhs>>::value ||
+     is_expression<std::decay_t<Rhs>>::value)>;
+
+template <typename Lhs, typename Rhs, typename = enable_if_operands<Lhs, Rhs>>
+make_node<plus, Lhs, Rhs> operator+(const Lhs& lhs, const Rhs& rhs) {
+  return {as_expression(lhs), as_expression(rhs)};
+}
+
+template <typename Lhs, typename Rhs, typename = enable_if_operands<Lhs, Rhs>>
+make_node<minus, Lhs, Rhs> operator-(const Lhs& lhs, const Rhs& rhs) {
+  return {as_expression(lhs), as_expression(rhs)};
+}
+
+template <typename Lhs, typename Rhs, typename = enable_if_operands<Lhs, Rhs>>
+make_node<multiplies, Lhs, Rhs> operator*(const Lhs& lhs, const Rhs& rhs) {
+  return {as_expression(lhs), as_expression(rhs)};
+}
+
+template <typename Lhs, typename Rhs, typename = enable_if_operands<Lhs, Rhs>>
+make_node<divides, Lhs, Rhs> operator/(const Lhs& lhs, const Rhs& rhs) {
+  return {as_expression(lhs), as_expression(rhs)};
+}
+
+template <typename Expr, cl::sycl::access::mode Mode>
+class fused_assign;
+
+}  // namespace expr
+
+template <typename T>
+class device_vector {
+ public:
+  using value_type = T;
+
+  device_vector(cl::sycl::queue queue, size_t size)
+      : queue_{std::move(queue)}, buf_{cl::sycl::range<1>(size)} {}
+
+  /* The data is written back to the host vector when the device_vector is
+   * destroyed, in the same way as a buffer constructed from a host pointer. */
+  device_vector(cl::sycl::queue queue, std::vector<T>& host)
+      : queue_{std::move(queue)},
+        buf_{host.data(), cl::sycl::range<1>(host.size())} {}
+
+  device_vector(const device_vector&) = delete;
+
+  /* Copies another vector; this also goes through the fused kernel. */
+  device_vector& operator=(const device_vector& other) {
+    return assign(expr::as_expression(other));
+  }
+
+  template <typename Expr,
+            typename = std::enable_if_t<expr::is_expression<Expr>::value>>
+  device_vector& operator=(const Expr& e) {
+    return assign(expr::as_expression(e));
+  }
+
+  size_t size() const { return buf_.get_count(); }
+
+  cl::sycl::buffer<T, 1> get_buffer() const { return buf_; }
+
+  cl::sycl::queue& get_queue() noexcept { return queue_; }
+
+ private:
+  /* Checked rather than asserted, as the benchmarks are built with NDEBUG.
+   * Unless the expression reads this vector, its old contents are discarded
+   * rather than copied to the device. */
+  template <typename Expr>
+  device_vector& assign(const Expr& e) {
+    if (e.size() != size()) {
+      throw std::invalid_argument("device_vector: assigned size differs");
+    }
+
+    if (e.uses(buf_)) {
+      submit_assign<cl::sycl::access::mode::write>(e);
+    } else {
+      submit_assign<cl::sycl::access::mode::discard_write>(e);
+    }
+
+    return *this;
+  }
+
+  template <cl::sycl::access::mode Mode, typename Expr>
+  void submit_assign(const Expr& e) {
+    queue_.submit([&](cl::sycl::handler& cgh) {
+      auto eval = e.bind(cgh);
+      auto outputAcc = buf_.template get_access<Mode>(cgh);
+
+      cgh.parallel_for<expr::fused_assign<Expr, Mode>>(
+          cl::sycl::range<1>(size()), [=](cl::sycl::id<1> idx) {
+            outputAcc[idx] = static_cast<T>(eval(idx[0]));
+          });
+    });
+  }
+
+  cl::sycl::queue queue_;
+  cl::sycl::buffer<T, 1> buf_;
+};
+
+using expr::operator+;
+using expr::operator-;
+using expr::operator*;
+using expr::operator/;
+
+}  // namespace cppcon
+
+#endif  // __DEVICE_VECTOR_H__
@@ -0,0 +1,156 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __EXECUTION_CONTEXT_H__
+#define __EXECUTION_CONTEXT_H__
+
+#include <chrono>
+#include <future>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <typeindex>
+#include <typeinfo>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+namespace detail {
+
+/* Kernel names are usually incomplete types, so can't be passed to typeid
+ * directly. */
+template <typename KernelName>
+struct kernel_name_tag {};
+
+}  // namespace detail
+
+/* Holds a queue, its context and the kernels which have been built for it,
+ * so that repeated calls to an entry point such as parallel_add don't pay for
+ * device selection, context creation and kernel compilation every time.
+ *
+ * Kernels are built on first use with the SYCL 1.2.1 program class and
+ * cached by kernel name type, or ahead of their first use with warm_up. A
+ * kernel which is still being built when it's needed is waited for rather
+ * than built twice. hipSYCL doesn't provide the program class, so there only
+ * the queue and context are reused. */
+class execution_context {
+ public:
+  execution_context() = default;
+
+  explicit execution_context(const cl::sycl::device_selector& selector)
+      : queue_{selector} {}
+
+  explicit execution_context(cl::sycl::queue queue)
+      : queue_{std::move(queue)} {}
+
+  cl::sycl::queue& get_queue() noexcept { return queue_; }
+
+  cl::sycl::context get_context() const { return queue_.get_context(); }
+
+  cl::sycl::device get_device() const { return queue_.get_device(); }
+
+#ifndef __HIPSYCL__
+  template <typename KernelName>
+  cl::sycl::kernel get_kernel() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    auto cached = kernels_.find(typeid(detail::kernel_name_tag<KernelName>));
+    if (cached != kernels_.end()) {
+      auto kernel = cached->second;
+      lock.unlock();
+      return kernel.get();
+    }
+
+    /* Build without holding the lock, so that other kernels can be looked
+     * up, or built, meanwhile. */
+    std::promise<cl::sycl::kernel> built;
+    kernels_.emplace(typeid(detail::kernel_name_tag<KernelName>),
+                     built.get_future().share());
+    lock.unlock();
+
+    try {
+      cl::sycl::program program{queue_.get_context()};
+      program.build_with_kernel_type<KernelName>();
+      auto kernel = program.get_kernel<KernelName>();
+      built.set_value(kernel);
+      return kernel;
+    } catch (...) {
+      built.set_exception(std::current_exception());
+      throw;
+    }
+  }
+
+  /* True if the kernel for KernelName has been built, without waiting. */
+  template <typename KernelName>
+  bool is_built() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto cached = kernels_.find(typeid(detail::kernel_name_tag<KernelName>));
+    return cached != kernels_.end() &&
+           cached->second.wait_for(std::chrono::seconds(0)) ==
+               std::future_status::ready;
+  }
+#endif  // __HIPSYCL__
+
+  /* Builds the kernels for KernelNames on a background thread, so that the
+   * first command groups to use them don't wait for JIT compilation. Call it
+   * at startup, as soon as the context exists, and keep the returned future
+   * until the rest of startup is done: it comes from std::async, so
+   * destroying it waits for the build, which would put the build back on the
+   * critical path. The execution_context must outlive the future. Any build
+   * error is rethrown by the future and by get_kernel for that kernel. */
+  template <typename... KernelNames>
+  [[nodiscard]] std::future<void> warm_up() {
+#ifndef __HIPSYCL__
+    return std::async(std::launch::async, [this]() {
+      (void)std::initializer_list<int>{(get_kernel<KernelNames>(), 0)...};
+    });
+#else
+    std::promise<void> ready;
+    ready.set_value();
+    return ready.get_future();
+#endif  // __HIPSYCL__
+  }
+
+  /* Enqueues a parallel_for using the cached kernel for KernelName, should be
+   * called from within a command group submitted to get_queue(). */
+  template <typename KernelName, int Dims, typename KernelFunc>
+  void parallel_for(cl::sycl::handler& cgh, cl::sycl::range<Dims> range,
+                    KernelFunc&& kernelFunc) {
+#ifndef __HIPSYCL__
+    cgh.parallel_for<KernelName>(get_kernel<KernelName>(), range,
+                                 std::forward<KernelFunc>(kernelFunc));
+#else
+    cgh.parallel_for<KernelName>(range, std::forward<KernelFunc>(kernelFunc));
+#endif  // __HIPSYCL__
+  }
+
+  template <typename KernelName, int Dims, typename KernelFunc>
+  void parallel_for(cl::sycl::handler& cgh, cl::sycl::nd_range<Dims> ndRange,
+                    KernelFunc&& kernelFunc) {
+#ifndef __HIPSYCL__
+    cgh.parallel_for<KernelName>(get_kernel<KernelName>(), ndRange,
+                                 std::forward<KernelFunc>(kernelFunc));
+#else
+    cgh.parallel_for<KernelName>(ndRange,
+                                 std::forward<KernelFunc>(kernelFunc));
+#endif  // __HIPSYCL__
+  }
+
+ private:
+  cl::sycl::queue queue_;
+#ifndef __HIPSYCL__
+  std::mutex mutex_;
+  std::map<std::type_index, std::shared_future<cl::sycl::kernel>> kernels_;
+#endif  // __HIPSYCL__
+};
+
+}  // namespace cppcon
+
+#endif  // __EXECUTION_CONTEXT_H__
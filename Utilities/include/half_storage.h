@@ -0,0 +1,272 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __HALF_STORAGE_H__
+#define __HALF_STORAGE_H__
+
+#include <benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+/* The vector add, grayscale and transpose kernels of the exercises, templated
+ * on the type their data is stored in. They load each element, convert it to
+ * float, compute in float and convert the result back to the storage type to
+ * store it, so storing in cl::sycl::half halves the bytes moved by these
+ * bandwidth-bound kernels, at the cost of half's 11 bits of precision and
+ * range of +/-65504.
+ *
+ * Devices without cl_khr_fp16 can't run the half kernels, so use with_storage
+ * to fall back to float storage on them. */
+
+namespace cppcon {
+
+/* The machine epsilon of half, 2^-10. Converting a float in half's range to
+ * half has a relative error of at most half of this. */
+constexpr float half_epsilon = 0.0009765625f;
+
+enum class storage_precision { single, half };
+
+inline bool has_fp16(const cl::sycl::device& dev) {
+  return dev.is_host() || dev.has_extension("cl_khr_fp16");
+}
+
+/* The precision to store data in on dev: requested, unless that's half and
+ * dev doesn't support it. */
+inline storage_precision select_storage(const cl::sycl::device& dev,
+                                        storage_precision requested) {
+  if (requested == storage_precision::half && !has_fp16(dev)) {
+    return storage_precision::single;
+  }
+  return requested;
+}
+
+/* Calls func with a value of the storage type selected for dev, a float or a
+ * cl::sycl::half, for it to take as an auto parameter and get the type with
+ * decltype, so that only kernels dev supports are submitted. */
+template <typename Func>
+auto with_storage(const cl::sycl::device& dev, storage_precision requested,
+                  Func&& func) {
+  if (select_storage(dev, requested) == storage_precision::half) {
+    return func(cl::sycl::half{});
+  }
+  return func(float{});
+}
+
+/* Host conversions between storage types. Floats beyond half's range become
+ * infinities. */
+template <typename To, typename From>
+std::vector<To> convert_storage(const std::vector<From>& from) {
+  std::vector<To> to(from.size());
+  std::transform(from.begin(), from.end(), to.begin(),
+                 [](From value) { return static_cast<To>(value); });
+  return to;
+}
+
+inline std::vector<cl::sycl::half> to_half(const std::vector<float>& from) {
+  return convert_storage<cl::sycl::half>(from);
+}
+
+inline std::vector<float> to_float(const std::vector<cl::sycl::half>& from) {
+  return convert_storage<float>(from);
+}
+
+/* The largest error in result relative to expected, with expected values
+ * smaller than one compared absolutely, so that zeros don't dominate. */
+template <typename T>
+float max_relative_error(const std::vector<T>& result,
+                         const std::vector<float>& expected) {
+  float maxError = 0.0f;
+  for (size_t i = 0; i < std::min(result.size(), expected.size()); ++i) {
+    const float error = std::abs(static_cast<float>(result[i]) - expected[i]) /
+                        std::max(1.0f, std::abs(expected[i]));
+    maxError = std::max(maxError, error);
+  }
+  return maxError;
+}
+
+template <typename Storage>
+class stored_add_kernel;
+
+template <typename Storage>
+class stored_grayscale_kernel;
+
+template <typename Storage>
+class stored_transpose_kernel;
+
+template <typename Storage>
+void stored_add(cl::sycl::queue& queue, cl::sycl::buffer<Storage, 1>& inputA,
+                cl::sycl::buffer<Storage, 1>& inputB,
+                cl::sycl::buffer<Storage, 1>& output) {
+  queue.submit([&](cl::sycl::handler& cgh) {
+    auto inputAAcc =
+        inputA.template get_access<cl::sycl::access::mode::read>(cgh);
+    auto inputBAcc =
+        inputB.template get_access<cl::sycl::access::mode::read>(cgh);
+    auto outputAcc =
+        output.template get_access<cl::sycl::access::mode::discard_write>(cgh);
+
+    cgh.parallel_for<stored_add_kernel<Storage>>(
+        output.get_range(), [=](cl::sycl::id<1> idx) {
+          const float sum = static_cast<float>(inputAAcc[idx]) +
+                            static_cast<float>(inputBAcc[idx]);
+          outputAcc[idx] = static_cast<Storage>(sum);
+        });
+  });
+}
+
+/* Converts 4 channel RGBA image data to grayscale in place, as in the
+ * coalesced grayscale solution. */
+template <typename Storage>
+void stored_grayscale(cl::sycl::queue& queue,
+                      cl::sycl::buffer<Storage, 1>& imageData, size_t width,
+                      size_t height) {
+  queue.submit([&](cl::sycl::handler& cgh) {
+    auto imageAcc =
+        imageData.template get_access<cl::sycl::access::mode::read_write>(cgh);
+
+    cgh.parallel_for<stored_grayscale_kernel<Storage>>(
+        cl::sycl::range<2>(height, width), [=](cl::sycl::id<2> idx) {
+          const size_t pixel = (idx[0] * width + idx[1]) * 4;
+          const float y = static_cast<float>(imageAcc[pixel]) * 0.299f +
+                          static_cast<float>(imageAcc[pixel + 1]) * 0.587f +
+                          static_cast<float>(imageAcc[pixel + 2]) * 0.114f;
+          const Storage stored = static_cast<Storage>(y);
+          imageAcc[pixel] = stored;
+          imageAcc[pixel + 1] = stored;
+          imageAcc[pixel + 2] = stored;
+        });
+  });
+}
+
+/* Transposes a rows x cols row-major matrix into a cols x rows row-major
+ * matrix through a tileSize x tileSize tile of local memory, which is also
+ * in the storage type. */
+template <typename Storage>
+void stored_transpose(cl::sycl::queue& queue,
+                      cl::sycl::buffer<Storage, 1>& input,
+                      cl::sycl::buffer<Storage, 1>& output, size_t rows,
+                      size_t cols, size_t tileSize = 16) {
+  const auto roundUp = [=](size_t value) {
+    return ((value + tileSize - 1) / tileSize) * tileSize;
+  };
+
+  queue.submit([&](cl::sycl::handler& cgh) {
+    auto inputAcc =
+        input.template get_access<cl::sycl::access::mode::read>(cgh);
+    auto outputAcc =
+        output.template get_access<cl::sycl::access::mode::discard_write>(cgh);
+
+    /* Padding each row of the tile by one staggers the columns across local
+     * memory banks. */
+    const size_t tileStride = tileSize + 1;
+    auto tile = cl::sycl::accessor<Storage, 1,
+                                   cl::sycl::access::mode::read_write,
+                                   cl::sycl::access::target::local>(
+        cl::sycl::range<1>(tileSize * tileStride), cgh);
+
+    cgh.parallel_for<stored_transpose_kernel<Storage>>(
+        cl::sycl::nd_range<2>(cl::sycl::range<2>(roundUp(rows), roundUp(cols)),
+                              cl::sycl::range<2>(tileSize, tileSize)),
+        [=](cl::sycl::nd_item<2> item) {
+          const size_t localRow = item.get_local_id(0);
+          const size_t localCol = item.get_local_id(1);
+
+          const size_t row = item.get_global_id(0);
+          const size_t col = item.get_global_id(1);
+          if (row < rows && col < cols) {
+            tile[localRow * tileStride + localCol] = inputAcc[row * cols + col];
+          }
+
+          item.barrier(cl::sycl::access::fence_space::local_space);
+
+          /* Each work-item writes the element of the transposed tile at its
+           * own position, so consecutive work-items write consecutive
+           * elements of the output. */
+          const size_t outRow = item.get_group(1) * tileSize + localRow;
+          const size_t outCol = item.get_group(0) * tileSize + localCol;
+          if (outRow < cols && outCol < rows) {
+            outputAcc[outRow * rows + outCol] =
+                tile[localCol * tileStride + localRow];
+          }
+        });
+  });
+}
+
+namespace detail {
+
+template <typename Storage, typename Body>
+void measure_storage_throughput(cl::sycl::queue& queue,
+                                double elementAccesses, int iterations,
+                                std::vector<benchmark_result>& results,
+                                Body& body) {
+  const std::string name = std::is_same<Storage, cl::sycl::half>::value
+                               ? "half storage"
+                               : "float storage";
+
+  body(Storage{}, [&](auto&& run) {
+    /* The first run moves the data to the device. */
+    run();
+    queue.wait_and_throw();
+
+    auto time = benchmark(
+        [&]() {
+          run();
+          queue.wait_and_throw();
+        },
+        iterations, name);
+    results.emplace_back(name, time);
+
+    std::cout << name << ": "
+              << elementAccesses * sizeof(Storage) / (time.count() * 1e6)
+              << "GB/s\n\n";
+  });
+}
+
+}  // namespace detail
+
+/* Benchmarks a kernel with its data stored in float and then in half, and
+ * prints the times side-by-side under caption. body is called as with
+ * with_storage, and also with a measure function: it converts the data and
+ * creates the buffers, and then passes measure a function which submits the
+ * kernel once. elementAccesses is the number of elements the kernel reads and
+ * writes, from which the bandwidth achieved is printed. The half run is
+ * skipped, saying so, on devices without cl_khr_fp16. */
+template <typename Body>
+void compare_storage_throughput(cl::sycl::queue& queue,
+                                const std::string& caption,
+                                double elementAccesses, int iterations,
+                                Body&& body) {
+  std::vector<benchmark_result> results;
+
+  detail::measure_storage_throughput<float>(queue, elementAccesses,
+                                            iterations, results, body);
+  if (has_fp16(queue.get_device())) {
+    detail::measure_storage_throughput<cl::sycl::half>(
+        queue, elementAccesses, iterations, results, body);
+  } else {
+    std::cout << "half storage skipped: "
+              << queue.get_device().get_info<cl::sycl::info::device::name>()
+              << " doesn't support cl_khr_fp16\n\n";
+  }
+
+  print_comparison(results, caption);
+}
+
+}  // namespace cppcon
+
+#endif  // __HALF_STORAGE_H__
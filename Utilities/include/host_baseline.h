@@ -0,0 +1,147 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __HOST_BASELINE_H__
+#define __HOST_BASELINE_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <execution>
+#include <vector>
+
+/* Plain C++ implementations of the exercise kernels, used as a reference for
+ * checking the results of the SYCL kernels and as a baseline for deciding
+ * whether offloading to a SYCL CPU device is worthwhile. */
+
+namespace cppcon {
+namespace host {
+
+template <typename T>
+void serial_add(const std::vector<T> &inputA, const std::vector<T> &inputB,
+                std::vector<T> &output) {
+  for (size_t i = 0; i < output.size(); ++i) {
+    output[i] = inputA[i] + inputB[i];
+  }
+}
+
+template <typename T>
+void par_unseq_add(const std::vector<T> &inputA, const std::vector<T> &inputB,
+                   std::vector<T> &output) {
+  std::transform(std::execution::par_unseq, inputA.begin(), inputA.end(),
+                 inputB.begin(), output.begin(),
+                 [](T a, T b) { return a + b; });
+}
+
+struct rgba {
+  float r, g, b, a;
+};
+
+inline rgba grayscale_pixel(rgba p) {
+  float y = (p.r * 0.299f) + (p.g * 0.587f) + (p.b * 0.114f);
+  return rgba{y, y, y, p.a};
+}
+
+/* The image data is expected to be 4 channel RGBA, as loaded by stbi_load
+ * with 4 desired channels. */
+inline void serial_grayscale(std::vector<float> &imageData) {
+  auto pixels = reinterpret_cast<rgba *>(imageData.data());
+  for (size_t i = 0; i < imageData.size() / 4; ++i) {
+    pixels[i] = grayscale_pixel(pixels[i]);
+  }
+}
+
+inline void par_unseq_grayscale(std::vector<float> &imageData) {
+  auto pixels = reinterpret_cast<rgba *>(imageData.data());
+  std::transform(std::execution::par_unseq, pixels,
+                 pixels + (imageData.size() / 4), pixels, grayscale_pixel);
+}
+
+/* Transposes a rows x cols row-major matrix into a cols x rows row-major
+ * matrix. */
+template <typename T>
+void serial_transpose(const T *input, T *output, size_t rows, size_t cols) {
+  for (size_t r = 0; r < rows; ++r) {
+    for (size_t c = 0; c < cols; ++c) {
+      output[(c * rows) + r] = input[(r * cols) + c];
+    }
+  }
+}
+
+namespace detail {
+
+template <typename T>
+void recursive_transpose(const T *input, T *output, size_t rows, size_t cols,
+                         size_t rowBegin, size_t rowEnd, size_t colBegin,
+                         size_t colEnd) {
+  static constexpr size_t blockSize = 16;
+
+  const auto rowExtent = rowEnd - rowBegin;
+  const auto colExtent = colEnd - colBegin;
+
+  if (rowExtent <= blockSize && colExtent <= blockSize) {
+    for (size_t r = rowBegin; r < rowEnd; ++r) {
+      for (size_t c = colBegin; c < colEnd; ++c) {
+        output[(c * rows) + r] = input[(r * cols) + c];
+      }
+    }
+  } else if (rowExtent >= colExtent) {
+    const auto rowMid = rowBegin + (rowExtent / 2);
+    recursive_transpose(input, output, rows, cols, rowBegin, rowMid, colBegin,
+                        colEnd);
+    recursive_transpose(input, output, rows, cols, rowMid, rowEnd, colBegin,
+                        colEnd);
+  } else {
+    const auto colMid = colBegin + (colExtent / 2);
+    recursive_transpose(input, output, rows, cols, rowBegin, rowEnd, colBegin,
+                        colMid);
+    recursive_transpose(input, output, rows, cols, rowBegin, rowEnd, colMid,
+                        colEnd);
+  }
+}
+
+}  // namespace detail
+
+/* Cache-oblivious transpose which recursively halves the larger dimension
+ * until the block fits comfortably in cache, regardless of the cache sizes. */
+template <typename T>
+void recursive_transpose(const T *input, T *output, size_t rows, size_t cols) {
+  detail::recursive_transpose(input, output, rows, cols, 0, rows, 0, cols);
+}
+
+template <typename T>
+bool bit_equal(const T *a, const T *b, size_t size) {
+  return std::memcmp(a, b, size * sizeof(T)) == 0;
+}
+
+template <typename T>
+bool bit_equal(const std::vector<T> &a, const std::vector<T> &b) {
+  return a.size() == b.size() && bit_equal(a.data(), b.data(), a.size());
+}
+
+template <typename T>
+bool equal_within(const std::vector<T> &a, const std::vector<T> &b,
+                  T tolerance) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (std::abs(a[i] - b[i]) > tolerance) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace host
+}  // namespace cppcon
+
+#endif  // __HOST_BASELINE_H__
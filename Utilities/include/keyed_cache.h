@@ -0,0 +1,76 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __KEYED_CACHE_H__
+#define __KEYED_CACHE_H__
+
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+
+namespace cppcon {
+
+/* Returns the path in the environment variable if it is set, and otherwise
+ * the default file name, which is relative to the working directory. */
+inline std::string cache_path(const char* environmentVariable,
+                              const std::string& defaultFileName) {
+  if (const char* path = std::getenv(environmentVariable)) {
+    return path;
+  }
+  return defaultFileName;
+}
+
+/* An on-disk cache of measurements, as a plain text file with one entry per
+ * line: a key, a tab, and the value. Keys may contain anything but newlines,
+ * as the value is taken from after the last tab. The values are left to the
+ * user to format and parse, and the whole file is rewritten on each store. */
+class keyed_cache {
+ public:
+  explicit keyed_cache(std::string path) : path_{std::move(path)} {
+    std::ifstream file(path_);
+    std::string line;
+    while (std::getline(file, line)) {
+      auto tab = line.rfind('\t');
+      if (tab == std::string::npos) {
+        continue;
+      }
+      entries_[line.substr(0, tab)] = line.substr(tab + 1);
+    }
+  }
+
+  bool lookup(const std::string& key, std::string& value) const {
+    auto entry = entries_.find(key);
+    if (entry == entries_.end()) {
+      return false;
+    }
+    value = entry->second;
+    return true;
+  }
+
+  void store(const std::string& key, const std::string& value) {
+    entries_[key] = value;
+
+    std::ofstream file(path_, std::ios::trunc);
+    for (const auto& entry : entries_) {
+      file << entry.first << "\t" << entry.second << "\n";
+    }
+  }
+
+  const std::string& path() const noexcept { return path_; }
+
+ private:
+  std::string path_;
+  std::map<std::string, std::string> entries_;
+};
+
+}  // namespace cppcon
+
+#endif  // __KEYED_CACHE_H__
@@ -0,0 +1,287 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __MEMORY_FOOTPRINT_H__
+#define __MEMORY_FOOTPRINT_H__
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#elif defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+#include <CL/sycl.hpp>
+
+/* Memory footprint instrumentation for the benchmarks: the bytes held in SYCL
+ * buffers and USM allocations which have been registered with the
+ * memory_tracker, and the resident set size of the host process. benchmark
+ * samples both around the function it times and reports the peak and the
+ * steady state, what is still held once it returns. */
+
+namespace cppcon {
+
+enum class memory_kind { buffer, usm_device, usm_host, usm_shared };
+
+constexpr size_t memory_kind_count = 4;
+
+/* Process-wide counts of the bytes currently allocated, of each kind and in
+ * total, and the peak total since the last reset_peak. Allocations are
+ * registered by tracked_buffer, tracking_usm_allocator, usm_pool and
+ * tracked_allocation. */
+class memory_tracker {
+ public:
+  static memory_tracker& instance() {
+    static memory_tracker tracker;
+    return tracker;
+  }
+
+  void allocated(size_t bytes, memory_kind kind) {
+    current_[static_cast<size_t>(kind)] += bytes;
+    const size_t total = total_ += bytes;
+    size_t peak = peak_.load();
+    while (total > peak && !peak_.compare_exchange_weak(peak, total)) {
+    }
+  }
+
+  void deallocated(size_t bytes, memory_kind kind) {
+    current_[static_cast<size_t>(kind)] -= bytes;
+    total_ -= bytes;
+  }
+
+  size_t current() const { return total_; }
+
+  size_t current(memory_kind kind) const {
+    return current_[static_cast<size_t>(kind)];
+  }
+
+  size_t peak() const { return peak_; }
+
+  void reset_peak() { peak_ = total_.load(); }
+
+ private:
+  memory_tracker() = default;
+
+  std::array<std::atomic<size_t>, memory_kind_count> current_{};
+  std::atomic<size_t> total_{0};
+  std::atomic<size_t> peak_{0};
+};
+
+/* Registers bytes with the memory_tracker for as long as it lives, for memory
+ * whose allocation can't be intercepted, such as a buffer's. */
+class tracked_allocation {
+ public:
+  tracked_allocation() = default;
+
+  tracked_allocation(size_t bytes, memory_kind kind)
+      : bytes_{bytes}, kind_{kind} {
+    memory_tracker::instance().allocated(bytes_, kind_);
+  }
+
+  tracked_allocation(tracked_allocation&& other) noexcept
+      : bytes_{other.bytes_}, kind_{other.kind_} {
+    other.bytes_ = 0;
+  }
+
+  tracked_allocation& operator=(tracked_allocation&& other) noexcept {
+    std::swap(bytes_, other.bytes_);
+    std::swap(kind_, other.kind_);
+    return *this;
+  }
+
+  ~tracked_allocation() {
+    if (bytes_ > 0) {
+      memory_tracker::instance().deallocated(bytes_, kind_);
+    }
+  }
+
+  size_t bytes() const { return bytes_; }
+
+ private:
+  size_t bytes_ = 0;
+  memory_kind kind_ = memory_kind::buffer;
+};
+
+/* Registers a buffer's size with the memory_tracker. Keep the result alive
+ * for as long as the buffer:
+ *
+ *   cl::sycl::buffer<float, 1> buf{range};
+ *   auto tracked = cppcon::track_buffer(buf); */
+template <typename Buffer>
+tracked_allocation track_buffer(const Buffer& buf) {
+  return tracked_allocation{buf.get_size(), memory_kind::buffer};
+}
+
+/* A buffer which registers its size with the memory_tracker for as long as it,
+ * or any copy of it, lives, so that the benchmarks report the buffers they use
+ * without tracking each by hand. It is constructed as a buffer would be:
+ *
+ *   cppcon::tracked_buffer<float, 1> buf{data, range}; */
+template <typename T, int Dims = 1>
+class tracked_buffer : public cl::sycl::buffer<T, Dims> {
+ public:
+  template <typename Arg, typename... Args,
+            typename = std::enable_if_t<
+                !std::is_base_of<tracked_buffer, std::decay_t<Arg>>::value>>
+  tracked_buffer(Arg&& arg, Args&&... args)
+      : cl::sycl::buffer<T, Dims>(std::forward<Arg>(arg),
+                                  std::forward<Args>(args)...),
+        tracked_{std::make_shared<tracked_allocation>(this->get_size(),
+                                                      memory_kind::buffer)} {}
+
+ private:
+  std::shared_ptr<tracked_allocation> tracked_;
+};
+
+/* The resident set size of the process, and its peak, in bytes, or 0 where
+ * they can't be read. */
+struct host_memory {
+  size_t rss = 0;
+  size_t peakRss = 0;
+};
+
+inline host_memory read_host_memory() {
+  host_memory memory;
+#if defined(__linux__)
+  std::ifstream status{"/proc/self/status"};
+  std::string line;
+  while (std::getline(status, line)) {
+    std::istringstream fields{line};
+    std::string name;
+    size_t kiB = 0;
+    fields >> name >> kiB;
+    if (name == "VmRSS:") {
+      memory.rss = kiB * 1024;
+    } else if (name == "VmHWM:") {
+      memory.peakRss = kiB * 1024;
+    }
+  }
+  if (memory.peakRss == 0) {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    memory.peakRss = static_cast<size_t>(usage.ru_maxrss) * 1024;
+  }
+#elif defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters{};
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                           sizeof(counters))) {
+    memory.rss = counters.WorkingSetSize;
+    memory.peakRss = counters.PeakWorkingSetSize;
+  }
+#endif
+  return memory;
+}
+
+/* Resets the peak resident set size to the current one, so that the next
+ * read_host_memory reports the peak since now rather than since the process
+ * started. Only Linux supports this; returns whether it succeeded. */
+inline bool reset_host_peak() {
+#if defined(__linux__)
+  std::ofstream clearRefs{"/proc/self/clear_refs"};
+  clearRefs << "5";
+  clearRefs.flush();
+  return static_cast<bool>(clearRefs);
+#else
+  return false;
+#endif
+}
+
+/* The memory used while running a benchmark: the peak and, once it returned,
+ * the steady state, of the host's resident set and of the tracked buffer and
+ * USM allocations. */
+struct memory_footprint {
+  size_t peakRss = 0;
+  size_t steadyRss = 0;
+  /* False if the peak couldn't be reset, so is the peak of the process. */
+  bool peakRssReset = false;
+  size_t peakTracked = 0;
+  size_t steadyTracked = 0;
+  /* Tracked bytes held when the benchmark started. */
+  size_t initialTracked = 0;
+
+  /* Tracked bytes allocated by the benchmark and not freed. */
+  size_t retained() const {
+    return steadyTracked > initialTracked ? steadyTracked - initialTracked : 0;
+  }
+};
+
+/* Samples the memory footprint from construction to finish. */
+class footprint_probe {
+ public:
+  footprint_probe() {
+    auto& tracker = memory_tracker::instance();
+    tracker.reset_peak();
+    footprint_.initialTracked = tracker.current();
+    footprint_.peakRssReset = reset_host_peak();
+  }
+
+  memory_footprint finish() {
+    auto& tracker = memory_tracker::instance();
+    const auto host = read_host_memory();
+    footprint_.peakRss = host.peakRss;
+    footprint_.steadyRss = host.rss;
+    footprint_.peakTracked = tracker.peak();
+    footprint_.steadyTracked = tracker.current();
+    return footprint_;
+  }
+
+ private:
+  memory_footprint footprint_;
+};
+
+inline std::string format_bytes(size_t bytes) {
+  static const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+  double value = static_cast<double>(bytes);
+  size_t unit = 0;
+  while (value >= 1024.0 && unit + 1 < std::size(units)) {
+    value /= 1024.0;
+    ++unit;
+  }
+  std::ostringstream str;
+  str << std::fixed << std::setprecision(unit == 0 ? 0 : 1) << value
+      << units[unit];
+  return str.str();
+}
+
+inline std::ostream& operator<<(std::ostream& os,
+                                const memory_footprint& footprint) {
+  os << "memory: host peak " << format_bytes(footprint.peakRss)
+     << (footprint.peakRssReset ? "" : " (since process start)")
+     << ", steady " << format_bytes(footprint.steadyRss);
+  if (footprint.peakTracked > 0) {
+    os << "; tracked peak " << format_bytes(footprint.peakTracked)
+       << ", steady " << format_bytes(footprint.steadyTracked);
+    if (footprint.retained() > 0) {
+      os << " (" << format_bytes(footprint.retained()) << " retained)";
+    }
+  }
+  return os;
+}
+
+}  // namespace cppcon
+
+#endif  // __MEMORY_FOOTPRINT_H__
@@ -0,0 +1,160 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __NUMA_H__
+#define __NUMA_H__
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* Partitions a device into one sub-device per NUMA node. If the device can't
+ * be partitioned by NUMA affinity domain, for example the host device or a
+ * single socket CPU, this returns the device itself, so callers can always
+ * treat the result as a list of devices to spread work across. */
+inline std::vector<cl::sycl::device> numa_sub_devices(
+    const cl::sycl::device& dev) {
+  using namespace cl::sycl;
+
+  if (dev.is_host() ||
+      dev.get_info<info::device::partition_max_sub_devices>() < 2) {
+    return {dev};
+  }
+
+  auto properties = dev.get_info<info::device::partition_properties>();
+  if (std::find(properties.begin(), properties.end(),
+                info::partition_property::partition_by_affinity_domain) ==
+      properties.end()) {
+    return {dev};
+  }
+
+  auto domains = dev.get_info<info::device::partition_affinity_domains>();
+  if (std::find(domains.begin(), domains.end(),
+                info::partition_affinity_domain::numa) == domains.end()) {
+    return {dev};
+  }
+
+  try {
+    auto subDevices = dev.create_sub_devices<
+        info::partition_property::partition_by_affinity_domain>(
+        info::partition_affinity_domain::numa);
+    if (!subDevices.empty()) {
+      return subDevices;
+    }
+  } catch (const cl::sycl::exception&) {
+    /* Some implementations report the property but fail to partition, for
+     * example when there is only one NUMA node. */
+  }
+  return {dev};
+}
+
+/* One queue per NUMA sub-device of dev. */
+inline std::vector<cl::sycl::queue> numa_queues(const cl::sycl::device& dev) {
+  std::vector<cl::sycl::queue> queues;
+  for (const auto& subDevice : numa_sub_devices(dev)) {
+    queues.emplace_back(subDevice);
+  }
+  return queues;
+}
+
+/* A one dimensional array split into one buffer per queue, sized in
+ * proportion to the compute units of each queue's device. The buffers are
+ * created without host data, so memory is allocated by the runtime and, on a
+ * CPU device, placed on whichever node first writes to it. Initialising each
+ * part with a kernel on the queue that owns it, and only ever processing it
+ * there, keeps each sub-device working on memory local to its own socket.
+ *
+ * A queue's part is empty when there are fewer elements than parts, in which
+ * case no buffer is allocated for it and for_each_part doesn't launch on it. */
+template <typename T>
+class partitioned_buffer {
+ public:
+  partitioned_buffer(const std::vector<cl::sycl::queue>& queues, size_t size)
+      : size_{size} {
+    size_t totalUnits = 0;
+    std::vector<size_t> units;
+    for (const auto& q : queues) {
+      units.push_back(std::max<size_t>(
+          q.get_device()
+              .template get_info<cl::sycl::info::device::max_compute_units>(),
+          1));
+      totalUnits += units.back();
+    }
+
+    size_t offset = 0;
+    size_t cumulativeUnits = 0;
+    for (size_t p = 0; p < queues.size(); ++p) {
+      cumulativeUnits += units[p];
+      size_t end = (p == queues.size() - 1)
+                       ? size
+                       : (size * cumulativeUnits) / totalUnits;
+      offsets_.push_back(offset);
+      sizes_.push_back(end - offset);
+      parts_.emplace_back();
+      if (end > offset) {
+        parts_.back().emplace(cl::sycl::range<1>(end - offset));
+      }
+      offset = end;
+    }
+  }
+
+  size_t size() const noexcept { return size_; }
+  size_t num_parts() const noexcept { return parts_.size(); }
+
+  /* Only valid for parts which aren't empty. */
+  cl::sycl::buffer<T, 1>& get_part(size_t p) { return *parts_[p]; }
+  size_t part_offset(size_t p) const { return offsets_[p]; }
+  size_t part_size(size_t p) const { return sizes_[p]; }
+
+  /* Copies every part into out, which must hold size() elements. */
+  void copy_to(std::vector<T>& out) {
+    for (size_t p = 0; p < parts_.size(); ++p) {
+      if (!parts_[p]) {
+        continue;
+      }
+      auto acc =
+          parts_[p]->template get_access<cl::sycl::access::mode::read>();
+      for (size_t i = 0; i < sizes_[p]; ++i) {
+        out[offsets_[p] + i] = acc[i];
+      }
+    }
+  }
+
+ private:
+  size_t size_;
+  std::vector<std::optional<cl::sycl::buffer<T, 1>>> parts_;
+  std::vector<size_t> offsets_;
+  std::vector<size_t> sizes_;
+};
+
+/* Calls submit(queue, part) for every queue whose part of layout isn't empty,
+ * then waits for all of them, so that the parts are processed concurrently.
+ * submit must return the event of the work it submits. */
+template <typename T, typename Submit>
+void for_each_part(std::vector<cl::sycl::queue>& queues,
+                   const partitioned_buffer<T>& layout, Submit&& submit) {
+  std::vector<cl::sycl::event> events;
+  for (size_t p = 0; p < queues.size(); ++p) {
+    if (layout.part_size(p) != 0) {
+      events.push_back(submit(queues[p], p));
+    }
+  }
+  for (auto& event : events) {
+    event.wait_and_throw();
+  }
+}
+
+}  // namespace cppcon
+
+#endif  // __NUMA_H__
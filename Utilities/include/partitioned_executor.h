@@ -0,0 +1,231 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __PARTITIONED_EXECUTOR_H__
+#define __PARTITIONED_EXECUTOR_H__
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* How much of a partitioned range each queue processed, and how long for. */
+struct partition_report {
+  struct device_share {
+    std::string deviceName;
+    size_t elements;
+    size_t chunks;
+    std::chrono::duration<double, std::milli> busyTime;
+  };
+
+  std::vector<device_share> shares;
+  std::chrono::duration<double, std::milli> totalTime{0};
+
+  void print(std::string caption) const {
+    size_t total = 0;
+    for (const auto& share : shares) {
+      total += share.elements;
+    }
+
+    std::cout << caption << ": " << totalTime.count() << "ms\n";
+    for (const auto& share : shares) {
+      std::cout << "  " << std::left << std::setw(40) << share.deviceName
+                << std::right << std::setw(8) << std::fixed
+                << std::setprecision(1)
+                << (100.0 * share.elements) / std::max<size_t>(total, 1)
+                << "%" << std::setw(8) << share.chunks << " chunks"
+                << std::setw(12) << std::setprecision(3)
+                << share.busyTime.count() << "ms busy\n";
+      std::cout.unsetf(std::ios::fixed);
+    }
+    std::cout << "\n";
+  }
+};
+
+/* Splits a one dimensional range across several queues, for example one per
+ * device, and runs a function on each part. The function is called as
+ * func(queue, offset, count) and must block until it has finished its part of
+ * the range.
+ *
+ * run_static splits the range once, in proportion to the weights, which
+ * default to an even split. run_dynamic starts from the same proportional
+ * split, but each queue takes its part a chunk at a time and, once its own
+ * part is exhausted, steals chunks from the back of whichever part has the
+ * most remaining, so faster devices end up processing more. The measured
+ * throughput of a run can be fed back into the weights with update_weights. */
+class partitioned_executor {
+ public:
+  explicit partitioned_executor(std::vector<cl::sycl::queue> queues,
+                                std::vector<double> weights = {})
+      : queues_{std::move(queues)}, weights_{std::move(weights)} {
+    if (weights_.size() != queues_.size()) {
+      weights_.assign(queues_.size(), 1.0);
+    }
+  }
+
+  /* One queue for every device of every platform, which in SYCL 1.2.1
+   * includes the host device. */
+  static std::vector<cl::sycl::queue> all_device_queues() {
+    std::vector<cl::sycl::queue> queues;
+    for (const auto& dev : cl::sycl::device::get_devices()) {
+      queues.emplace_back(dev);
+    }
+    return queues;
+  }
+
+  const std::vector<cl::sycl::queue>& queues() const noexcept {
+    return queues_;
+  }
+
+  const std::vector<double>& weights() const noexcept { return weights_; }
+
+  /* Sets the weights to the elements per millisecond each queue achieved. */
+  void update_weights(const partition_report& report) {
+    for (size_t q = 0; q < queues_.size(); ++q) {
+      const auto& share = report.shares[q];
+      if (share.elements > 0 && share.busyTime.count() > 0) {
+        weights_[q] = share.elements / share.busyTime.count();
+      }
+    }
+  }
+
+  template <typename Func>
+  partition_report run_static(size_t size, Func&& func) {
+    auto parts = split(size);
+    return run(parts, size, false, func);
+  }
+
+  template <typename Func>
+  partition_report run_dynamic(size_t size, size_t chunkSize, Func&& func) {
+    auto parts = split(size);
+    return run(parts, std::max<size_t>(chunkSize, 1), true, func);
+  }
+
+ private:
+  struct part {
+    size_t begin;
+    size_t end;
+  };
+
+  std::vector<part> split(size_t size) const {
+    const double totalWeight =
+        std::accumulate(weights_.begin(), weights_.end(), 0.0);
+
+    std::vector<part> parts(queues_.size());
+    size_t begin = 0;
+    double cumulativeWeight = 0.0;
+    for (size_t q = 0; q < queues_.size(); ++q) {
+      cumulativeWeight += weights_[q];
+      size_t end = (q == queues_.size() - 1)
+                       ? size
+                       : static_cast<size_t>(size * (cumulativeWeight /
+                                                     totalWeight));
+      end = std::max(begin, std::min(end, size));
+      parts[q] = part{begin, end};
+      begin = end;
+    }
+    return parts;
+  }
+
+  /* Takes the next chunk from the front of the queue's own part, or if steal is
+   * set, steals one from the back of the largest remaining part. */
+  static bool next_chunk(std::vector<part>& parts, std::mutex& mutex, size_t q,
+                         size_t chunkSize, bool steal, part& chunk) {
+    std::lock_guard<std::mutex> lock{mutex};
+
+    auto& own = parts[q];
+    if (own.begin < own.end) {
+      chunk = part{own.begin, std::min(own.end, own.begin + chunkSize)};
+      own.begin = chunk.end;
+      return true;
+    }
+    if (!steal) {
+      return false;
+    }
+
+    auto victim = std::max_element(
+        parts.begin(), parts.end(), [](const part& a, const part& b) {
+          return (a.end - a.begin) < (b.end - b.begin);
+        });
+    if (victim->begin == victim->end) {
+      return false;
+    }
+
+    const size_t count = std::min(chunkSize, victim->end - victim->begin);
+    chunk = part{victim->end - count, victim->end};
+    victim->end = chunk.begin;
+    return true;
+  }
+
+  template <typename Func>
+  partition_report run(std::vector<part> parts, size_t chunkSize, bool steal,
+                       Func& func) {
+    partition_report report;
+    report.shares.resize(queues_.size());
+    for (size_t q = 0; q < queues_.size(); ++q) {
+      report.shares[q] = partition_report::device_share{
+          queues_[q].get_device().get_info<cl::sycl::info::device::name>(),
+          0, 0, std::chrono::duration<double, std::milli>{0}};
+    }
+
+    std::mutex mutex;
+    std::exception_ptr error;
+    auto start = std::chrono::steady_clock::now();
+
+    /* One host thread drives each queue, so that a blocking call on one
+     * device doesn't hold up the others. */
+    std::vector<std::thread> threads;
+    for (size_t q = 0; q < queues_.size(); ++q) {
+      threads.emplace_back([&, q]() {
+        auto& share = report.shares[q];
+        part chunk;
+        try {
+          while (next_chunk(parts, mutex, q, chunkSize, steal, chunk)) {
+            auto chunkStart = std::chrono::steady_clock::now();
+            func(queues_[q], chunk.begin, chunk.end - chunk.begin);
+            share.busyTime += std::chrono::steady_clock::now() - chunkStart;
+            share.elements += chunk.end - chunk.begin;
+            ++share.chunks;
+          }
+        } catch (...) {
+          std::lock_guard<std::mutex> lock{mutex};
+          error = std::current_exception();
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    report.totalTime = std::chrono::steady_clock::now() - start;
+
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    return report;
+  }
+
+  std::vector<cl::sycl::queue> queues_;
+  std::vector<double> weights_;
+};
+
+}  // namespace cppcon
+
+#endif  // __PARTITIONED_EXECUTOR_H__
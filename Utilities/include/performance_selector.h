@@ -0,0 +1,257 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __PERFORMANCE_SELECTOR_H__
+#define __PERFORMANCE_SELECTOR_H__
+
+#include <keyed_cache.h>
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* Measured by short micro-benchmarks, see measure_device_performance. */
+struct device_performance {
+  double launchLatencyUs;
+  double bandwidthGBs;
+  double computeGFlops;
+};
+
+namespace detail {
+
+class score_latency;
+class score_bandwidth;
+class score_compute;
+
+template <typename Func>
+double average_ms(cl::sycl::queue& queue, int iterations, Func&& func) {
+  /* The first run includes building the kernel. */
+  func();
+  queue.wait_and_throw();
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    func();
+  }
+  queue.wait_and_throw();
+  std::chrono::duration<double, std::milli> time =
+      std::chrono::steady_clock::now() - start;
+  return time.count() / iterations;
+}
+
+/* The time from submitting an empty kernel to it completing. */
+inline double measure_launch_latency_us(cl::sycl::queue& queue) {
+  return 1000.0 * average_ms(queue, 20, [&]() {
+           queue
+               .submit([&](cl::sycl::handler& cgh) {
+                 cgh.single_task<score_latency>([=]() {});
+               })
+               .wait_and_throw();
+         });
+}
+
+/* Device memory bandwidth of a copy kernel, counting a read and a write per
+ * element. */
+inline double measure_bandwidth_gbs(cl::sycl::queue& queue) {
+  using namespace cl::sycl;
+  const size_t size = 1 << 22;
+
+  buffer<float, 1> in{range<1>(size)};
+  buffer<float, 1> out{range<1>(size)};
+
+  auto ms = average_ms(queue, 5, [&]() {
+    queue.submit([&](handler& cgh) {
+      auto inAcc = in.get_access<access::mode::read>(cgh);
+      auto outAcc = out.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for<score_bandwidth>(range<1>(size), [=](id<1> i) {
+        outAcc[i] = inAcc[i];
+      });
+    });
+  });
+  return (2.0 * size * sizeof(float)) / (ms * 1e6);
+}
+
+/* Single precision throughput of a chain of multiply-adds per work-item. */
+inline double measure_compute_gflops(cl::sycl::queue& queue) {
+  using namespace cl::sycl;
+  const size_t size = 1 << 18;
+  const int iterations = 256;
+
+  buffer<float, 1> out{range<1>(size)};
+
+  auto ms = average_ms(queue, 5, [&]() {
+    queue.submit([&](handler& cgh) {
+      auto outAcc = out.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for<score_compute>(range<1>(size), [=](id<1> i) {
+        float a = static_cast<float>(i[0]) * 1e-6f;
+        float b = 1.0f - a;
+        for (int k = 0; k < iterations; ++k) {
+          a = a * b + 0.5f;
+          b = b * a + 0.25f;
+        }
+        outAcc[i] = a + b;
+      });
+    });
+  });
+  return (4.0 * iterations * size) / (ms * 1e6);
+}
+
+}  // namespace detail
+
+/* Runs all three micro-benchmarks on dev, which takes a fraction of a second
+ * on most devices. Asynchronous errors are rethrown by the queue's handler
+ * when the benchmarks wait, so a device which fails them throws rather than
+ * being scored on work which never ran. */
+inline device_performance measure_device_performance(
+    const cl::sycl::device& dev) {
+  cl::sycl::queue queue{dev, [](cl::sycl::exception_list errors) {
+                          for (auto& error : errors) {
+                            std::rethrow_exception(error);
+                          }
+                        }};
+  device_performance performance;
+  performance.launchLatencyUs = detail::measure_launch_latency_us(queue);
+  performance.bandwidthGBs = detail::measure_bandwidth_gbs(queue);
+  performance.computeGFlops = detail::measure_compute_gflops(queue);
+  return performance;
+}
+
+/* Measured device performance, persisted to a keyed_cache with one line per
+ * device, keyed by device name, vendor and driver version, so that a driver
+ * update causes the device to be measured again. The path can be set with the
+ * SYCL_ACADEMY_DEVICE_SCORES environment variable. */
+class device_performance_cache {
+ public:
+  explicit device_performance_cache(std::string path = default_path())
+      : cache_{std::move(path)} {}
+
+  static std::string default_path() {
+    return cache_path("SYCL_ACADEMY_DEVICE_SCORES",
+                      "sycl_academy_device_scores.txt");
+  }
+
+  static std::string key(const cl::sycl::device& dev) {
+    std::ostringstream key;
+    key << dev.get_info<cl::sycl::info::device::name>() << "|"
+        << dev.get_info<cl::sycl::info::device::vendor>() << "|"
+        << dev.get_info<cl::sycl::info::device::driver_version>();
+    return key.str();
+  }
+
+  bool lookup(const std::string& key, device_performance& performance) const {
+    std::string value;
+    if (!cache_.lookup(key, value)) {
+      return false;
+    }
+    std::istringstream values(value);
+    device_performance read;
+    if (!(values >> read.launchLatencyUs >> read.bandwidthGBs >>
+          read.computeGFlops)) {
+      return false;
+    }
+    performance = read;
+    return true;
+  }
+
+  void store(const std::string& key, const device_performance& performance) {
+    std::ostringstream values;
+    values << performance.launchLatencyUs << " " << performance.bandwidthGBs
+           << " " << performance.computeGFlops;
+    cache_.store(key, values.str());
+  }
+
+  const std::string& path() const noexcept { return cache_.path(); }
+
+ private:
+  keyed_cache cache_;
+};
+
+/* How much each measurement counts towards a performance_selector score. */
+struct performance_weights {
+  double latency = 1.0;
+  double bandwidth = 1.0;
+  double compute = 1.0;
+};
+
+/* A device selector which scores devices by their measured performance
+ * rather than their type. Each device is measured the first time it is scored,
+ * unless it is found in the cache, and the result is stored in the cache so
+ * that later processes don't need to measure it again.
+ *
+ * Each measurement is scored relative to a reference device with 10us launch
+ * latency, 10GB/s bandwidth and 100GFLOPS, and the scores are combined with
+ * the given weights, so for example a bandwidth bound application can weight
+ * bandwidth more heavily. Devices which fail to run the micro-benchmarks are
+ * rejected. */
+class performance_selector : public cl::sycl::device_selector {
+ public:
+  using weights = performance_weights;
+
+  explicit performance_selector(
+      weights w = weights{},
+      std::string cachePath = device_performance_cache::default_path())
+      : weights_{w}, cache_{std::move(cachePath)} {}
+
+  int operator()(const cl::sycl::device& dev) const override {
+    device_performance perf;
+    try {
+      perf = performance(dev);
+    } catch (const cl::sycl::exception&) {
+      return -1;
+    }
+    return score(perf, weights_);
+  }
+
+  static int score(const device_performance& perf, const weights& w) {
+    const double total = w.latency + w.bandwidth + w.compute;
+    const double relative =
+        (w.latency * (10.0 / std::max(perf.launchLatencyUs, 1e-3)) +
+         w.bandwidth * (perf.bandwidthGBs / 10.0) +
+         w.compute * (perf.computeGFlops / 100.0)) /
+        std::max(total, 1e-9);
+    return static_cast<int>(
+        std::min(1000.0 * relative, static_cast<double>(INT_MAX)));
+  }
+
+  /* The device's performance, from the cache or measured now. */
+  device_performance performance(const cl::sycl::device& dev) const {
+    const auto key = device_performance_cache::key(dev);
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    device_performance perf;
+    if (!cache_.lookup(key, perf)) {
+      perf = measure_device_performance(dev);
+      cache_.store(key, perf);
+      ++measured_;
+    }
+    return perf;
+  }
+
+  /* The number of devices this selector has had to measure. */
+  size_t measured() const noexcept { return measured_; }
+
+ private:
+  weights weights_;
+  mutable device_performance_cache cache_;
+  mutable std::mutex mutex_;
+  mutable size_t measured_ = 0;
+};
+
+}  // namespace cppcon
+
+#endif  // __PERFORMANCE_SELECTOR_H__
@@ -0,0 +1,105 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __QUEUE_POOL_H__
+#define __QUEUE_POOL_H__
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* A fixed set of queues on one device, for submitting from many host threads
+ * at once. A single shared queue serialises the threads on the runtime's
+ * per-queue locks, and a queue per thread creates a queue, with the runtime's
+ * state for it, for every thread, so the pool sits between the two. Which
+ * size is fastest depends on the system, so it is given rather than guessed:
+ * the submission_scaling benchmarks measure it, see best_pool_size.
+ *
+ * The queues share a context, so buffers and USM allocations can be used on
+ * any of them. Each thread is given one of the queues on its first submission
+ * and keeps it, round-robin across threads, so that a thread's submissions
+ * stay on one queue and its dependencies on earlier ones don't cross queues.
+ * Everything is safe to call from any thread. */
+class queue_pool {
+ public:
+  queue_pool(const cl::sycl::device& dev, size_t size,
+             const cl::sycl::property_list& properties = {})
+      : id_{next_pool_id()} {
+    const cl::sycl::context ctx{dev};
+    queues_.reserve(std::max<size_t>(size, 1));
+    for (size_t q = 0; q < std::max<size_t>(size, 1); ++q) {
+      queues_.emplace_back(ctx, dev, properties);
+    }
+  }
+
+  size_t size() const noexcept { return queues_.size(); }
+
+  cl::sycl::context get_context() const {
+    return queues_.front().get_context();
+  }
+
+  cl::sycl::queue& operator[](size_t index) { return queues_[index]; }
+
+  /* The next queue in turn, regardless of the calling thread. */
+  cl::sycl::queue& next() {
+    return queues_[nextQueue_.fetch_add(1, std::memory_order_relaxed) %
+                   queues_.size()];
+  }
+
+  /* The calling thread's queue, the same one on every call. A thread
+   * remembers its queue for each pool it has used, so alternating between
+   * pools keeps it on the same queue of each. */
+  cl::sycl::queue& for_this_thread() {
+    thread_local std::unordered_map<std::uint64_t, size_t> slots;
+    auto slot = slots.find(id_);
+    if (slot == slots.end()) {
+      const size_t index =
+          nextThread_.fetch_add(1, std::memory_order_relaxed) % queues_.size();
+      slot = slots.emplace(id_, index).first;
+    }
+    return queues_[slot->second];
+  }
+
+  template <typename CommandGroup>
+  cl::sycl::event submit(CommandGroup&& cgf) {
+    return for_this_thread().submit(std::forward<CommandGroup>(cgf));
+  }
+
+  void wait_and_throw() {
+    for (auto& queue : queues_) {
+      queue.wait_and_throw();
+    }
+  }
+
+ private:
+  /* Ids rather than addresses identify pools, as a pool may be created where
+   * a destroyed one was. */
+  static std::uint64_t next_pool_id() {
+    static std::atomic<std::uint64_t> nextId{1};
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  std::uint64_t id_;
+  std::vector<cl::sycl::queue> queues_;
+  std::atomic<size_t> nextQueue_{0};
+  std::atomic<size_t> nextThread_{0};
+};
+
+}  // namespace cppcon
+
+#endif  // __QUEUE_POOL_H__
@@ -0,0 +1,362 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __REDUCE_SCAN_H__
+#define __REDUCE_SCAN_H__
+
+#include <algorithm>
+#include <cstddef>
+
+#include <usm_pointer.h>
+
+#include <CL/sycl.hpp>
+
+/* Generic reduce, transform_reduce, inclusive_scan and exclusive_scan over
+ * SYCL buffers and USM pointers.
+ *
+ * Reductions are performed as a tree within each work-group in local memory,
+ * producing one partial result per work-group, which are reduced again in
+ * further passes until a single value remains. Scans are performed as a
+ * Hillis-Steele scan of each work-group sized tile in local memory, the tile
+ * totals are then scanned recursively, and a final pass adds the scanned
+ * total of the preceding tiles to each element.
+ *
+ * As with std::reduce the binary operation must be associative and, for the
+ * reductions, commutative. The operations form part of the kernel names, so
+ * must be function objects declared at namespace scope, such as std::plus<T>,
+ * rather than lambdas. */
+
+namespace cppcon {
+
+namespace detail {
+
+struct identity {
+  template <typename T>
+  T operator()(T value) const {
+    return value;
+  }
+};
+
+/* The largest power of two work-group size supported by the device, up to a
+ * limit of 256. */
+inline size_t collective_work_group_size(const cl::sycl::queue& queue) {
+  const auto maxWorkGroupSize =
+      queue.get_device().get_info<cl::sycl::info::device::max_work_group_size>();
+  size_t workGroupSize = 1;
+  while (workGroupSize * 2 <= std::min<size_t>(maxWorkGroupSize, 256)) {
+    workGroupSize *= 2;
+  }
+  return workGroupSize;
+}
+
+/* Inputs and outputs are bound inside the command group, to either an
+ * accessor or a USM pointer, so the same kernels can be used for both. */
+
+template <typename T>
+struct buffer_input {
+  cl::sycl::buffer<T, 1> buf;
+
+  auto bind(cl::sycl::handler& cgh) {
+    return buf.template get_access<cl::sycl::access::mode::read>(cgh);
+  }
+};
+
+template <typename T>
+struct buffer_output {
+  cl::sycl::buffer<T, 1> buf;
+
+  template <cl::sycl::access::mode Mode>
+  auto bind(cl::sycl::handler& cgh) {
+    return buf.template get_access<Mode>(cgh);
+  }
+};
+
+template <typename T>
+struct usm_input {
+  T* ptr;
+
+  usm_pointer<T> bind(cl::sycl::handler&) { return make_usm_pointer(ptr); }
+};
+
+template <typename T>
+struct usm_output {
+  T* ptr;
+
+  template <cl::sycl::access::mode Mode>
+  usm_pointer<T> bind(cl::sycl::handler&) {
+    return make_usm_pointer(ptr);
+  }
+};
+
+template <typename T, typename BinaryOp, typename UnaryOp, typename Input>
+class reduce_kernel;
+
+template <typename T, typename BinaryOp, typename Input, typename Output>
+class scan_tile_kernel;
+
+template <typename T, typename BinaryOp, typename Output>
+class scan_fixup_kernel;
+
+template <typename T, typename BinaryOp, typename Output>
+class exclusive_shift_kernel;
+
+/* Reduces the first count elements of the input to one partial result per
+ * work-group. The number of work-groups is capped at the work-group size, so
+ * that the next pass fits in a single work-group. */
+template <typename T, typename BinaryOp, typename UnaryOp, typename Input>
+cl::sycl::buffer<T, 1> reduce_partials(cl::sycl::queue& queue, Input input,
+                                       size_t count, BinaryOp op,
+                                       UnaryOp transform) {
+  const size_t workGroupSize = collective_work_group_size(queue);
+  const size_t groups = std::min(workGroupSize,
+                                 (count + workGroupSize - 1) / workGroupSize);
+  const size_t globalSize = groups * workGroupSize;
+
+  cl::sycl::buffer<T, 1> partials{cl::sycl::range<1>(groups)};
+
+  queue.submit([&](cl::sycl::handler& cgh) {
+    auto in = input.bind(cgh);
+    auto out =
+        partials.template get_access<cl::sycl::access::mode::discard_write>(
+            cgh);
+    auto scratch =
+        cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write,
+                           cl::sycl::access::target::local>(
+            cl::sycl::range<1>(workGroupSize), cgh);
+
+    cgh.parallel_for<reduce_kernel<T, BinaryOp, UnaryOp, Input>>(
+        cl::sycl::nd_range<1>(cl::sycl::range<1>(globalSize),
+                              cl::sycl::range<1>(workGroupSize)),
+        [=](cl::sycl::nd_item<1> item) {
+          const size_t globalId = item.get_global_id(0);
+          const size_t localId = item.get_local_id(0);
+
+          /* Each work-item first accumulates a strided subset of the input,
+           * only work-items with at least one element are valid. */
+          if (globalId < count) {
+            T acc = transform(in[globalId]);
+            for (size_t i = globalId + globalSize; i < count; i += globalSize) {
+              acc = op(acc, transform(in[i]));
+            }
+            scratch[localId] = acc;
+          }
+
+          size_t valid = std::min(
+              workGroupSize, count - (item.get_group(0) * workGroupSize));
+
+          item.barrier(cl::sycl::access::fence_space::local_space);
+
+          for (size_t stride = workGroupSize / 2; stride > 0; stride /= 2) {
+            if (localId < stride && localId + stride < valid) {
+              scratch[localId] = op(scratch[localId], scratch[localId + stride]);
+            }
+            item.barrier(cl::sycl::access::fence_space::local_space);
+            valid = std::min(valid, stride);
+          }
+
+          if (localId == 0) {
+            out[item.get_group(0)] = scratch[0];
+          }
+        });
+  });
+
+  return partials;
+}
+
+template <typename T, typename BinaryOp, typename UnaryOp, typename Input>
+T transform_reduce(cl::sycl::queue& queue, Input input, size_t count, T init,
+                   BinaryOp op, UnaryOp transform) {
+  if (count == 0) {
+    return init;
+  }
+
+  auto partials = reduce_partials<T>(queue, input, count, op, transform);
+  while (partials.get_count() > 1) {
+    partials = reduce_partials<T>(queue, buffer_input<T>{partials},
+                                  partials.get_count(), op, identity{});
+  }
+
+  auto result = partials.template get_access<cl::sycl::access::mode::read>();
+  return op(init, result[0]);
+}
+
+template <typename T, typename BinaryOp, typename Input, typename Output>
+void inclusive_scan(cl::sycl::queue& queue, Input input, Output output,
+                    size_t count, BinaryOp op) {
+  if (count == 0) {
+    return;
+  }
+
+  const size_t workGroupSize = collective_work_group_size(queue);
+  const size_t groups = (count + workGroupSize - 1) / workGroupSize;
+
+  cl::sycl::buffer<T, 1> sums{cl::sycl::range<1>(groups)};
+
+  queue.submit([&](cl::sycl::handler& cgh) {
+    auto in = input.bind(cgh);
+    auto out = output.template bind<cl::sycl::access::mode::write>(cgh);
+    auto sumsAcc =
+        sums.template get_access<cl::sycl::access::mode::discard_write>(cgh);
+    auto scratch =
+        cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write,
+                           cl::sycl::access::target::local>(
+            cl::sycl::range<1>(workGroupSize), cgh);
+
+    cgh.parallel_for<scan_tile_kernel<T, BinaryOp, Input, Output>>(
+        cl::sycl::nd_range<1>(cl::sycl::range<1>(groups * workGroupSize),
+                              cl::sycl::range<1>(workGroupSize)),
+        [=](cl::sycl::nd_item<1> item) {
+          const size_t globalId = item.get_global_id(0);
+          const size_t localId = item.get_local_id(0);
+
+          /* Work-items past the end load a duplicate element, their results
+           * only ever flow into later work-items which are also past the
+           * end, so are never written out. */
+          scratch[localId] = in[std::min(globalId, count - 1)];
+
+          item.barrier(cl::sycl::access::fence_space::local_space);
+
+          for (size_t offset = 1; offset < workGroupSize; offset *= 2) {
+            T value = scratch[localId];
+            if (localId >= offset) {
+              value = op(scratch[localId - offset], value);
+            }
+            item.barrier(cl::sycl::access::fence_space::local_space);
+            scratch[localId] = value;
+            item.barrier(cl::sycl::access::fence_space::local_space);
+          }
+
+          if (globalId < count) {
+            out[globalId] = scratch[localId];
+          }
+          if (localId == workGroupSize - 1) {
+            sumsAcc[item.get_group(0)] = scratch[localId];
+          }
+        });
+  });
+
+  if (groups == 1) {
+    return;
+  }
+
+  cl::sycl::buffer<T, 1> scannedSums{cl::sycl::range<1>(groups)};
+  inclusive_scan<T>(queue, buffer_input<T>{sums},
+                    buffer_output<T>{scannedSums}, groups, op);
+
+  queue.submit([&](cl::sycl::handler& cgh) {
+    auto out = output.template bind<cl::sycl::access::mode::read_write>(cgh);
+    auto scannedSumsAcc =
+        scannedSums.template get_access<cl::sycl::access::mode::read>(cgh);
+
+    cgh.parallel_for<scan_fixup_kernel<T, BinaryOp, Output>>(
+        cl::sycl::range<1>(count - workGroupSize), [=](cl::sycl::id<1> idx) {
+          const size_t globalId = idx[0] + workGroupSize;
+          out[globalId] =
+              op(scannedSumsAcc[(globalId / workGroupSize) - 1], out[globalId]);
+        });
+  });
+}
+
+template <typename T, typename BinaryOp, typename Input, typename Output>
+void exclusive_scan(cl::sycl::queue& queue, Input input, Output output,
+                    size_t count, T init, BinaryOp op) {
+  if (count == 0) {
+    return;
+  }
+
+  cl::sycl::buffer<T, 1> inclusive{cl::sycl::range<1>(count)};
+  detail::inclusive_scan<T>(queue, input, buffer_output<T>{inclusive}, count,
+                            op);
+
+  queue.submit([&](cl::sycl::handler& cgh) {
+    auto out = output.template bind<cl::sycl::access::mode::write>(cgh);
+    auto inclusiveAcc =
+        inclusive.template get_access<cl::sycl::access::mode::read>(cgh);
+
+    cgh.parallel_for<exclusive_shift_kernel<T, BinaryOp, Output>>(
+        cl::sycl::range<1>(count), [=](cl::sycl::id<1> idx) {
+          const size_t i = idx[0];
+          out[i] = (i == 0) ? init : op(init, inclusiveAcc[i - 1]);
+        });
+  });
+}
+
+}  // namespace detail
+
+/* Buffer overloads, these return once the work is enqueued and rely on the
+ * buffers to order any later accesses. */
+
+template <typename T, typename BinaryOp>
+T reduce(cl::sycl::queue& queue, cl::sycl::buffer<T, 1> buf, T init,
+         BinaryOp op) {
+  return detail::transform_reduce(queue, detail::buffer_input<T>{buf},
+                                  buf.get_count(), init, op,
+                                  detail::identity{});
+}
+
+template <typename T, typename U, typename BinaryOp, typename UnaryOp>
+T transform_reduce(cl::sycl::queue& queue, cl::sycl::buffer<U, 1> buf, T init,
+                   BinaryOp op, UnaryOp transform) {
+  return detail::transform_reduce(queue, detail::buffer_input<U>{buf},
+                                  buf.get_count(), init, op, transform);
+}
+
+template <typename T, typename BinaryOp>
+void inclusive_scan(cl::sycl::queue& queue, cl::sycl::buffer<T, 1> input,
+                    cl::sycl::buffer<T, 1> output, BinaryOp op) {
+  detail::inclusive_scan<T>(queue, detail::buffer_input<T>{input},
+                            detail::buffer_output<T>{output},
+                            input.get_count(), op);
+}
+
+template <typename T, typename BinaryOp>
+void exclusive_scan(cl::sycl::queue& queue, cl::sycl::buffer<T, 1> input,
+                    cl::sycl::buffer<T, 1> output, T init, BinaryOp op) {
+  detail::exclusive_scan(queue, detail::buffer_input<T>{input},
+                         detail::buffer_output<T>{output}, input.get_count(),
+                         init, op);
+}
+
+/* USM overloads, the input must already be available on the device, and
+ * these return once the result has been written. */
+
+template <typename T, typename BinaryOp>
+T reduce(cl::sycl::queue& queue, T* input, size_t count, T init,
+         BinaryOp op) {
+  return detail::transform_reduce(queue, detail::usm_input<T>{input}, count,
+                                  init, op, detail::identity{});
+}
+
+template <typename T, typename U, typename BinaryOp, typename UnaryOp>
+T transform_reduce(cl::sycl::queue& queue, U* input, size_t count, T init,
+                   BinaryOp op, UnaryOp transform) {
+  return detail::transform_reduce(queue, detail::usm_input<U>{input}, count,
+                                  init, op, transform);
+}
+
+template <typename T, typename BinaryOp>
+void inclusive_scan(cl::sycl::queue& queue, T* input, size_t count, T* output,
+                    BinaryOp op) {
+  detail::inclusive_scan<T>(queue, detail::usm_input<T>{input},
+                            detail::usm_output<T>{output}, count, op);
+  queue.wait_and_throw();
+}
+
+template <typename T, typename BinaryOp>
+void exclusive_scan(cl::sycl::queue& queue, T* input, size_t count, T* output,
+                    T init, BinaryOp op) {
+  detail::exclusive_scan(queue, detail::usm_input<T>{input},
+                         detail::usm_output<T>{output}, count, init, op);
+  queue.wait_and_throw();
+}
+
+}  // namespace cppcon
+
+#endif  // __REDUCE_SCAN_H__
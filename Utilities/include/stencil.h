@@ -0,0 +1,361 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __STENCIL_H__
+#define __STENCIL_H__
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+/* Iterative 2D stencils, such as a Jacobi solver for the heat equation, on a
+ * row-major grid whose boundary cells are held fixed.
+ *
+ * Each time step reads one buffer and writes the other, and the two are
+ * swapped rather than copied, so any number of steps run without a round-trip
+ * to the host. Three variants are provided:
+ *
+ *  - naive, where every work-item reads its neighbours from global memory.
+ *  - tiled, where each work-group first loads its tile and a one cell halo
+ *    into local memory, so each cell is read from global memory about once.
+ *  - temporal, where each work-group loads a halo as wide as the number of
+ *    steps per pass, and advances the tile that many steps in local memory
+ *    before writing it back, trading redundant work on the halo for fewer
+ *    passes over global memory. */
+
+namespace cppcon {
+
+/* Which neighbours a stencil reads: the four edges, or the edges and the
+ * four corners. */
+enum class stencil_shape { five_point, nine_point };
+
+/* The new value of a cell is
+ *   centre * cell + edge * (north + south + east + west)
+ *   + corner * (north-east + north-west + south-east + south-west)
+ * and corner is ignored by a five_point stencil. */
+template <typename T>
+struct stencil_coefficients {
+  T centre;
+  T edge;
+  T corner;
+
+  /* An explicit step of the heat equation with the usual five point
+   * Laplacian, stable for alpha up to 0.25. */
+  static stencil_coefficients heat_five_point(T alpha) {
+    return {T(1) - T(4) * alpha, alpha, T(0)};
+  }
+
+  /* The same with the isotropic nine point Laplacian,
+   * (4 * edges + corners - 20 * cell) / 6. */
+  static stencil_coefficients heat_nine_point(T alpha) {
+    return {T(1) - T(20) * alpha / T(6), T(4) * alpha / T(6), alpha / T(6)};
+  }
+};
+
+template <stencil_shape Shape, typename T, typename Load>
+T apply_stencil(const stencil_coefficients<T>& c, T cell, Load load) {
+  T value = c.centre * cell +
+            c.edge * (load(-1, 0) + load(1, 0) + load(0, -1) + load(0, 1));
+  if (Shape == stencil_shape::nine_point) {
+    value += c.corner *
+             (load(-1, -1) + load(-1, 1) + load(1, -1) + load(1, 1));
+  }
+  return value;
+}
+
+/* The two buffers a stencil ping-pongs between. The grid is height rows of
+ * width cells, so a cell is addressed by id<2>(row, column). */
+template <typename T>
+class stencil_grid {
+ public:
+  stencil_grid(size_t width, size_t height)
+      : buffers_{cl::sycl::buffer<T, 2>{cl::sycl::range<2>(height, width)},
+                 cl::sycl::buffer<T, 2>{cl::sycl::range<2>(height, width)}} {}
+
+  stencil_grid(const std::vector<T>& data, size_t width, size_t height)
+      : stencil_grid{width, height} {
+    if (data.size() != width * height) {
+      throw std::invalid_argument("stencil_grid: data is not width * height");
+    }
+    write(data);
+  }
+
+  size_t width() const { return buffers_[0].get_range()[1]; }
+
+  size_t height() const { return buffers_[0].get_range()[0]; }
+
+  size_t size() const { return width() * height(); }
+
+  /* The buffer holding the latest time step. */
+  cl::sycl::buffer<T, 2>& current() { return buffers_[current_]; }
+
+  cl::sycl::buffer<T, 2>& next() { return buffers_[1 - current_]; }
+
+  void swap() { current_ = 1 - current_; }
+
+  /* Replaces the latest time step. Every step copies the boundary cells
+   * through, so the other buffer needn't be written. */
+  void write(const std::vector<T>& data) {
+    auto acc =
+        current().template get_access<cl::sycl::access::mode::discard_write>();
+    for (size_t r = 0; r < height(); ++r) {
+      for (size_t c = 0; c < width(); ++c) {
+        acc[cl::sycl::id<2>(r, c)] = data[r * width() + c];
+      }
+    }
+  }
+
+  /* Waits for any steps in flight and copies the latest back. */
+  std::vector<T> read() {
+    auto acc = current().template get_access<cl::sycl::access::mode::read>();
+    std::vector<T> data(size());
+    for (size_t r = 0; r < height(); ++r) {
+      for (size_t c = 0; c < width(); ++c) {
+        data[r * width() + c] = acc[cl::sycl::id<2>(r, c)];
+      }
+    }
+    return data;
+  }
+
+ private:
+  cl::sycl::buffer<T, 2> buffers_[2];
+  int current_ = 0;
+};
+
+template <stencil_shape Shape, typename T>
+class stencil_naive_kernel;
+
+template <stencil_shape Shape, typename T>
+class stencil_tiled_kernel;
+
+template <stencil_shape Shape, typename T>
+class stencil_temporal_kernel;
+
+namespace detail {
+
+inline size_t round_up(size_t value, size_t multiple) {
+  return ((value + multiple - 1) / multiple) * multiple;
+}
+
+inline bool is_interior(size_t row, size_t col, size_t height, size_t width) {
+  return row > 0 && col > 0 && row + 1 < height && col + 1 < width;
+}
+
+}  // namespace detail
+
+/* Advances the grid steps time steps, one kernel per step. */
+template <stencil_shape Shape, typename T>
+void stencil_naive(cl::sycl::queue& queue, stencil_grid<T>& grid,
+                   stencil_coefficients<T> coefficients, size_t steps) {
+  const size_t width = grid.width();
+  const size_t height = grid.height();
+
+  for (size_t step = 0; step < steps; ++step) {
+    queue.submit([&](cl::sycl::handler& cgh) {
+      auto in =
+          grid.current().template get_access<cl::sycl::access::mode::read>(cgh);
+      auto out =
+          grid.next().template get_access<cl::sycl::access::mode::write>(cgh);
+
+      cgh.parallel_for<stencil_naive_kernel<Shape, T>>(
+          cl::sycl::range<2>(height, width), [=](cl::sycl::id<2> idx) {
+            const size_t row = idx[0];
+            const size_t col = idx[1];
+            if (!detail::is_interior(row, col, height, width)) {
+              out[idx] = in[idx];
+              return;
+            }
+            out[idx] = apply_stencil<Shape>(
+                coefficients, in[idx], [&](int dr, int dc) {
+                  return in[cl::sycl::id<2>(row + dr, col + dc)];
+                });
+          });
+    });
+    grid.swap();
+  }
+}
+
+/* Advances the grid steps time steps, one kernel per step, with each
+ * tileSize x tileSize work-group staging its tile and halo in local memory. */
+template <stencil_shape Shape, typename T>
+void stencil_tiled(cl::sycl::queue& queue, stencil_grid<T>& grid,
+                   stencil_coefficients<T> coefficients, size_t steps,
+                   size_t tileSize = 16) {
+  const size_t width = grid.width();
+  const size_t height = grid.height();
+  const size_t haloSize = tileSize + 2;
+
+  const auto ndRange = cl::sycl::nd_range<2>(
+      cl::sycl::range<2>(detail::round_up(height, tileSize),
+                         detail::round_up(width, tileSize)),
+      cl::sycl::range<2>(tileSize, tileSize));
+
+  for (size_t step = 0; step < steps; ++step) {
+    queue.submit([&](cl::sycl::handler& cgh) {
+      auto in =
+          grid.current().template get_access<cl::sycl::access::mode::read>(cgh);
+      auto out =
+          grid.next().template get_access<cl::sycl::access::mode::write>(cgh);
+      auto tile =
+          cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write,
+                             cl::sycl::access::target::local>(
+              cl::sycl::range<1>(haloSize * haloSize), cgh);
+
+      cgh.parallel_for<stencil_tiled_kernel<Shape, T>>(
+          ndRange, [=](cl::sycl::nd_item<2> item) {
+            const size_t firstRow = item.get_group(0) * tileSize;
+            const size_t firstCol = item.get_group(1) * tileSize;
+
+            /* The tile and its halo are loaded by the whole work-group, cells
+             * off the edge of the grid are never read. */
+            for (size_t i = item.get_local_linear_id();
+                 i < haloSize * haloSize; i += tileSize * tileSize) {
+              const size_t row = firstRow + i / haloSize - 1;
+              const size_t col = firstCol + i % haloSize - 1;
+              if (row < height && col < width) {
+                tile[i] = in[cl::sycl::id<2>(row, col)];
+              }
+            }
+
+            item.barrier(cl::sycl::access::fence_space::local_space);
+
+            const size_t row = item.get_global_id(0);
+            const size_t col = item.get_global_id(1);
+            if (row >= height || col >= width) {
+              return;
+            }
+
+            const size_t local = (item.get_local_id(0) + 1) * haloSize +
+                                 item.get_local_id(1) + 1;
+            if (!detail::is_interior(row, col, height, width)) {
+              out[item.get_global_id()] = tile[local];
+              return;
+            }
+            out[item.get_global_id()] = apply_stencil<Shape>(
+                coefficients, tile[local], [&](int dr, int dc) {
+                  return tile[local + dr * haloSize + dc];
+                });
+          });
+    });
+    grid.swap();
+  }
+}
+
+/* Advances the grid steps time steps, stepsPerPass at a time, with each
+ * tileSize x tileSize work-group loading its tile and a halo stepsPerPass
+ * cells wide into local memory. The region computed shrinks by a cell on each
+ * side every step, so after stepsPerPass steps only the tile is still valid,
+ * and that is written back. A final pass takes any remaining steps. */
+template <stencil_shape Shape, typename T>
+void stencil_temporal(cl::sycl::queue& queue, stencil_grid<T>& grid,
+                      stencil_coefficients<T> coefficients, size_t steps,
+                      size_t stepsPerPass = 4, size_t tileSize = 16) {
+  if (stepsPerPass == 0) {
+    throw std::invalid_argument("stencil_temporal: stepsPerPass is 0");
+  }
+
+  const size_t width = grid.width();
+  const size_t height = grid.height();
+
+  const auto ndRange = cl::sycl::nd_range<2>(
+      cl::sycl::range<2>(detail::round_up(height, tileSize),
+                         detail::round_up(width, tileSize)),
+      cl::sycl::range<2>(tileSize, tileSize));
+
+  for (size_t done = 0; done < steps;) {
+    const size_t passSteps = std::min(stepsPerPass, steps - done);
+    const size_t regionSize = tileSize + 2 * passSteps;
+    const size_t regionCells = regionSize * regionSize;
+
+    queue.submit([&](cl::sycl::handler& cgh) {
+      auto in =
+          grid.current().template get_access<cl::sycl::access::mode::read>(cgh);
+      auto out =
+          grid.next().template get_access<cl::sycl::access::mode::write>(cgh);
+      auto regionA =
+          cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write,
+                             cl::sycl::access::target::local>(
+              cl::sycl::range<1>(regionCells), cgh);
+      auto regionB =
+          cl::sycl::accessor<T, 1, cl::sycl::access::mode::read_write,
+                             cl::sycl::access::target::local>(
+              cl::sycl::range<1>(regionCells), cgh);
+
+      cgh.parallel_for<stencil_temporal_kernel<Shape, T>>(
+          ndRange, [=](cl::sycl::nd_item<2> item) {
+            const size_t groupSize = tileSize * tileSize;
+            const size_t localId = item.get_local_linear_id();
+
+            /* The grid coordinates of region cell 0, which may be off the
+             * top or left of the grid, in which case they wrap around and
+             * fail the bounds checks below. */
+            const size_t firstRow = item.get_group(0) * tileSize - passSteps;
+            const size_t firstCol = item.get_group(1) * tileSize - passSteps;
+
+            for (size_t i = localId; i < regionCells; i += groupSize) {
+              const size_t row = firstRow + i / regionSize;
+              const size_t col = firstCol + i % regionSize;
+              regionA[i] = (row < height && col < width)
+                               ? in[cl::sycl::id<2>(row, col)]
+                               : T{};
+            }
+
+            item.barrier(cl::sycl::access::fence_space::local_space);
+
+            /* Step s reads the region valid after step s - 1 and writes the
+             * cells at least s from its edge, so every cell it reads was
+             * itself valid. Boundary cells and cells outside that are copied,
+             * which keeps the two regions' boundaries in step. */
+            for (size_t s = 1; s <= passSteps; ++s) {
+              auto src = (s % 2 == 1) ? regionA : regionB;
+              auto dst = (s % 2 == 1) ? regionB : regionA;
+
+              for (size_t i = localId; i < regionCells; i += groupSize) {
+                const size_t r = i / regionSize;
+                const size_t c = i % regionSize;
+                const size_t row = firstRow + r;
+                const size_t col = firstCol + c;
+                const bool valid = r >= s && c >= s && r + s < regionSize &&
+                                   c + s < regionSize;
+                if (valid && detail::is_interior(row, col, height, width)) {
+                  dst[i] = apply_stencil<Shape>(
+                      coefficients, src[i], [&](int dr, int dc) {
+                        return src[i + dr * regionSize + dc];
+                      });
+                } else {
+                  dst[i] = src[i];
+                }
+              }
+
+              item.barrier(cl::sycl::access::fence_space::local_space);
+            }
+
+            const size_t row = item.get_global_id(0);
+            const size_t col = item.get_global_id(1);
+            if (row < height && col < width) {
+              const auto result = (passSteps % 2 == 1) ? regionB : regionA;
+              out[item.get_global_id()] =
+                  result[(item.get_local_id(0) + passSteps) * regionSize +
+                         item.get_local_id(1) + passSteps];
+            }
+          });
+    });
+    grid.swap();
+    done += passSteps;
+  }
+}
+
+}  // namespace cppcon
+
+#endif  // __STENCIL_H__
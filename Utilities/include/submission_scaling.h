@@ -0,0 +1,277 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __SUBMISSION_SCALING_H__
+#define __SUBMISSION_SCALING_H__
+
+#include <queue_pool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+/* Measures how submission scales with the number of host threads submitting
+ * at once, as a service with many request threads would: each thread makes a
+ * number of independent requests, and the throughput of all of them and the
+ * latency of each are reported, for the threads sharing a queue, having a
+ * queue each, or sharing a queue_pool. */
+
+namespace cppcon {
+
+enum class submission_strategy { shared_queue, per_thread_queues, queue_pool };
+
+inline const char* to_string(submission_strategy strategy) {
+  switch (strategy) {
+    case submission_strategy::shared_queue:
+      return "shared queue";
+    case submission_strategy::per_thread_queues:
+      return "per-thread queues";
+    default:
+      return "queue pool";
+  }
+}
+
+/* Percentiles of request latency, by the nearest rank, in microseconds. */
+struct latency_summary {
+  double p50Us = 0.0;
+  double p95Us = 0.0;
+  double p99Us = 0.0;
+  double maxUs = 0.0;
+};
+
+inline latency_summary summarise_latencies(std::vector<double> latenciesUs) {
+  latency_summary summary;
+  if (latenciesUs.empty()) {
+    return summary;
+  }
+  std::sort(latenciesUs.begin(), latenciesUs.end());
+  auto percentile = [&](double p) {
+    const size_t rank = static_cast<size_t>(p * latenciesUs.size() + 0.5);
+    return latenciesUs[std::min(std::max<size_t>(rank, 1),
+                                latenciesUs.size()) - 1];
+  };
+  summary.p50Us = percentile(0.50);
+  summary.p95Us = percentile(0.95);
+  summary.p99Us = percentile(0.99);
+  summary.maxUs = latenciesUs.back();
+  return summary;
+}
+
+struct scaling_result {
+  submission_strategy strategy;
+  size_t threads = 0;
+  /* The number of queues the threads submitted to. */
+  size_t queues = 0;
+  size_t requests = 0;
+  std::chrono::duration<double, std::milli> elapsed{0};
+  latency_summary latency;
+
+  double requests_per_second() const {
+    return elapsed.count() > 0.0 ? requests / (elapsed.count() / 1000.0)
+                                 : 0.0;
+  }
+};
+
+/* Runs threads host threads, each calling request(queue, thread, index)
+ * requestsPerThread times, where the request must block until its work is
+ * complete. poolSize is the number of queues of the queue_pool strategy, see
+ * best_pool_size. The queues are created, from a single context, before the
+ * threads start, and the threads start together once they have all been
+ * created. The elapsed time is from the start until the last thread finishes.
+ * Exceptions thrown by requests are rethrown once every thread has finished. */
+template <typename Request>
+scaling_result run_submission_scaling(const cl::sycl::device& dev,
+                                      submission_strategy strategy,
+                                      size_t threads,
+                                      size_t requestsPerThread,
+                                      size_t poolSize, Request&& request) {
+  const size_t queueCount =
+      strategy == submission_strategy::shared_queue        ? 1
+      : strategy == submission_strategy::per_thread_queues ? threads
+                                                           : poolSize;
+  queue_pool queues{dev, queueCount};
+
+  std::vector<std::vector<double>> latenciesUs(threads);
+  std::vector<std::exception_ptr> errors(threads);
+
+  std::mutex mutex;
+  std::condition_variable startCondition;
+  size_t waiting = 0;
+  bool started = false;
+  std::chrono::steady_clock::time_point start;
+
+  auto worker = [&](size_t thread) {
+    cl::sycl::queue& queue = strategy == submission_strategy::queue_pool
+                                 ? queues.for_this_thread()
+                                 : queues[thread % queueCount];
+    latenciesUs[thread].reserve(requestsPerThread);
+    {
+      std::unique_lock<std::mutex> lock{mutex};
+      if (++waiting == threads) {
+        started = true;
+        start = std::chrono::steady_clock::now();
+        startCondition.notify_all();
+      } else {
+        startCondition.wait(lock, [&]() { return started; });
+      }
+    }
+
+    try {
+      for (size_t index = 0; index < requestsPerThread; ++index) {
+        const auto requestStart = std::chrono::steady_clock::now();
+        request(queue, thread, index);
+        latenciesUs[thread].push_back(
+            std::chrono::duration<double, std::micro>(
+                std::chrono::steady_clock::now() - requestStart)
+                .count());
+      }
+    } catch (...) {
+      errors[thread] = std::current_exception();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (size_t thread = 0; thread < threads; ++thread) {
+    workers.emplace_back(worker, thread);
+  }
+  for (auto& thread : workers) {
+    thread.join();
+  }
+  const auto end = std::chrono::steady_clock::now();
+
+  for (auto& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  std::vector<double> allLatenciesUs;
+  for (const auto& threadLatencies : latenciesUs) {
+    allLatenciesUs.insert(allLatenciesUs.end(), threadLatencies.begin(),
+                          threadLatencies.end());
+  }
+
+  scaling_result result;
+  result.strategy = strategy;
+  result.threads = threads;
+  result.queues = queueCount;
+  result.requests = allLatenciesUs.size();
+  result.elapsed = end - start;
+  result.latency = summarise_latencies(std::move(allLatenciesUs));
+  return result;
+}
+
+/* 1, 2, 4, ... up to the hardware threads, or maxThreads if fewer. */
+inline std::vector<size_t> scaling_thread_counts(size_t maxThreads = 16) {
+  const size_t hardwareThreads =
+      std::max<size_t>(std::thread::hardware_concurrency(), 1);
+  const size_t limit = std::min(maxThreads, hardwareThreads);
+  std::vector<size_t> counts;
+  for (size_t threads = 1; threads < limit; threads *= 2) {
+    counts.push_back(threads);
+  }
+  counts.push_back(limit);
+  return counts;
+}
+
+/* Prints the results as a table, with the throughput of each relative to the
+ * single threaded result of the same strategy, and for a queue_pool of the
+ * same size, where there is one. */
+inline void print_scaling(const std::vector<scaling_result>& results,
+                          std::string caption) {
+  const auto flags = std::cout.flags();
+  const auto precision = std::cout.precision();
+  std::cout << caption << "\n"
+            << "  " << std::left << std::setw(20) << "strategy" << std::right
+            << std::setw(8) << "threads" << std::setw(8) << "queues"
+            << std::setw(12) << "req/s" << std::setw(9) << "scaling"
+            << std::setw(10) << "p50 us" << std::setw(10) << "p95 us"
+            << std::setw(10) << "p99 us" << std::setw(10) << "max us"
+            << "\n";
+  for (const auto& result : results) {
+    auto single = std::find_if(
+        results.begin(), results.end(), [&](const scaling_result& r) {
+          return r.strategy == result.strategy && r.threads == 1 &&
+                 (r.strategy != submission_strategy::queue_pool ||
+                  r.queues == result.queues);
+        });
+    std::cout << "  " << std::left << std::setw(20)
+              << to_string(result.strategy) << std::right << std::setw(8)
+              << result.threads << std::setw(8) << result.queues
+              << std::setw(12) << std::fixed << std::setprecision(0)
+              << result.requests_per_second() << std::setw(8)
+              << std::setprecision(2)
+              << (single != results.end()
+                      ? result.requests_per_second() /
+                            single->requests_per_second()
+                      : 1.0)
+              << "x" << std::setprecision(1) << std::setw(10)
+              << result.latency.p50Us << std::setw(10) << result.latency.p95Us
+              << std::setw(10) << result.latency.p99Us << std::setw(10)
+              << result.latency.maxUs << "\n";
+  }
+  std::cout << "\n";
+  std::cout.flags(flags);
+  std::cout.precision(precision);
+}
+
+/* The result with the highest throughput at the largest thread count.
+ * Throws std::invalid_argument if there are no results. */
+inline const scaling_result& best_at_most_threads(
+    const std::vector<scaling_result>& results) {
+  if (results.empty()) {
+    throw std::invalid_argument("best_at_most_threads: no results");
+  }
+  const size_t mostThreads =
+      std::max_element(results.begin(), results.end(),
+                       [](const scaling_result& a, const scaling_result& b) {
+                         return a.threads < b.threads;
+                       })
+          ->threads;
+  const scaling_result* best = nullptr;
+  for (const auto& result : results) {
+    if (result.threads == mostThreads &&
+        (!best || result.requests_per_second() > best->requests_per_second())) {
+      best = &result;
+    }
+  }
+  return *best;
+}
+
+/* The size of the queue_pool with the highest throughput at the largest thread
+ * count, the measured size to give a queue_pool for that many threads on this
+ * system. Throws std::invalid_argument if no queue_pool was measured. */
+inline size_t best_pool_size(const std::vector<scaling_result>& results) {
+  std::vector<scaling_result> pools;
+  std::copy_if(results.begin(), results.end(), std::back_inserter(pools),
+               [](const scaling_result& result) {
+                 return result.strategy == submission_strategy::queue_pool;
+               });
+  if (pools.empty()) {
+    throw std::invalid_argument("best_pool_size: no queue_pool results");
+  }
+  return best_at_most_threads(pools).queues;
+}
+
+}  // namespace cppcon
+
+#endif  // __SUBMISSION_SCALING_H__
@@ -0,0 +1,213 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __TASK_GRAPH_H__
+#define __TASK_GRAPH_H__
+
+/* When using ComputeCpp, include this after the ComputeCpp headers and the
+ * definition of depends_on as experimental_depends_on, as in Exercise 7. */
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* A range of bytes of USM memory which a task graph node reads or writes. */
+struct usm_range {
+  const void* ptr;
+  size_t bytes;
+
+  bool overlaps(const usm_range& other) const {
+    auto begin = static_cast<const char*>(ptr);
+    auto otherBegin = static_cast<const char*>(other.ptr);
+    return begin < otherBegin + other.bytes && otherBegin < begin + bytes;
+  }
+};
+
+template <typename T>
+usm_range make_usm_range(const T* ptr, size_t count) {
+  return usm_range{ptr, count * sizeof(T)};
+}
+
+/* A graph of copies, fills and kernels on USM memory. Each node declares the
+ * memory it reads and writes, and the dependencies between nodes are inferred
+ * from those in the order the nodes were added: a node depends on earlier
+ * nodes which write memory it reads or writes, or read memory it writes.
+ * Edges which are implied by other edges are dropped, so each node waits on as
+ * few events as possible.
+ *
+ * submit can be called repeatedly to replay the graph. Each replay also
+ * depends on the nodes of the previous submission which conflict with it, so
+ * iterations are correctly ordered without waiting on the host in between. */
+class task_graph {
+ public:
+  using node_id = size_t;
+
+  explicit task_graph(cl::sycl::queue queue) : queue_{std::move(queue)} {}
+
+  node_id add_copy(void* dest, const void* src, size_t bytes) {
+    return add_node({usm_range{src, bytes}}, {usm_range{dest, bytes}},
+                    [=](cl::sycl::handler& cgh) {
+                      cgh.memcpy(dest, src, bytes);
+                    });
+  }
+
+  template <typename T>
+  node_id add_fill(T* ptr, const T& value, size_t count) {
+    return add_node({}, {make_usm_range(ptr, count)},
+                    [=](cl::sycl::handler& cgh) {
+                      cgh.fill(ptr, value, count);
+                    });
+  }
+
+  /* cgf is called with the handler of the command group each time the node is
+   * submitted, and should enqueue a single kernel. */
+  node_id add_kernel(std::vector<usm_range> reads,
+                     std::vector<usm_range> writes,
+                     std::function<void(cl::sycl::handler&)> cgf) {
+    return add_node(std::move(reads), std::move(writes), std::move(cgf));
+  }
+
+  size_t size() const noexcept { return nodes_.size(); }
+
+  /* The nodes which node waits on within a submission. */
+  const std::vector<node_id>& get_dependencies(node_id node) {
+    build();
+    return dependencies_[node];
+  }
+
+  size_t num_edges() {
+    build();
+    size_t edges = 0;
+    for (const auto& deps : dependencies_) {
+      edges += deps.size();
+    }
+    return edges;
+  }
+
+  void submit() {
+    build();
+
+    std::vector<cl::sycl::event> events(nodes_.size());
+    for (node_id n = 0; n < nodes_.size(); ++n) {
+      events[n] = queue_.submit([&](cl::sycl::handler& cgh) {
+        for (auto d : dependencies_[n]) {
+          cgh.depends_on(events[d]);
+        }
+        if (!events_.empty()) {
+          for (auto d : carriedDependencies_[n]) {
+            cgh.depends_on(events_[d]);
+          }
+        }
+        nodes_[n].cgf(cgh);
+      });
+    }
+    events_ = std::move(events);
+  }
+
+  void replay(size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+      submit();
+    }
+  }
+
+  /* Waits for the most recent submission. */
+  void wait() {
+    for (auto& event : events_) {
+      event.wait_and_throw();
+    }
+    events_.clear();
+  }
+
+ private:
+  struct node {
+    std::vector<usm_range> reads;
+    std::vector<usm_range> writes;
+    std::function<void(cl::sycl::handler&)> cgf;
+  };
+
+  node_id add_node(std::vector<usm_range> reads, std::vector<usm_range> writes,
+                   std::function<void(cl::sycl::handler&)> cgf) {
+    nodes_.push_back(node{std::move(reads), std::move(writes), std::move(cgf)});
+    built_ = false;
+    return nodes_.size() - 1;
+  }
+
+  static bool any_overlap(const std::vector<usm_range>& a,
+                          const std::vector<usm_range>& b) {
+    for (const auto& x : a) {
+      for (const auto& y : b) {
+        if (x.overlaps(y)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  static bool conflicts(const node& earlier, const node& later) {
+    return any_overlap(earlier.writes, later.reads) ||
+           any_overlap(earlier.writes, later.writes) ||
+           any_overlap(earlier.reads, later.writes);
+  }
+
+  /* Infers the edges over two copies of the graph back to back. Edges of the
+   * second copy which point into the first are the dependencies a replay has
+   * on the previous submission. Later nodes are considered first, and a
+   * conflicting node is only added as a dependency if it isn't already an
+   * ancestor of one, which gives the transitive reduction. */
+  void build() {
+    if (built_) {
+      return;
+    }
+
+    const size_t count = nodes_.size();
+    std::vector<std::vector<bool>> ancestors(2 * count,
+                                             std::vector<bool>(2 * count));
+    dependencies_.assign(count, {});
+    carriedDependencies_.assign(count, {});
+
+    for (size_t n = 0; n < 2 * count; ++n) {
+      for (size_t m = n; m-- > 0;) {
+        if (ancestors[n][m] ||
+            !conflicts(nodes_[m % count], nodes_[n % count])) {
+          continue;
+        }
+
+        ancestors[n][m] = true;
+        for (size_t a = 0; a < m; ++a) {
+          if (ancestors[m][a]) {
+            ancestors[n][a] = true;
+          }
+        }
+
+        if (n < count) {
+          dependencies_[n].push_back(m);
+        } else if (m < count) {
+          carriedDependencies_[n - count].push_back(m);
+        }
+      }
+    }
+    built_ = true;
+  }
+
+  cl::sycl::queue queue_;
+  std::vector<node> nodes_;
+  std::vector<std::vector<node_id>> dependencies_;
+  std::vector<std::vector<node_id>> carriedDependencies_;
+  std::vector<cl::sycl::event> events_;
+  bool built_ = false;
+};
+
+}  // namespace cppcon
+
+#endif  // __TASK_GRAPH_H__
@@ -0,0 +1,39 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __USM_POINTER_H__
+#define __USM_POINTER_H__
+
+/* When using ComputeCpp, define SYCL_ACADEMY_USING_COMPUTECPP and include
+ * <SYCL/experimental/usm_wrapper.h>, <CL/sycl.hpp> and <SYCL/experimental.hpp>
+ * in that order before including this header, as in Exercise 7. */
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+/* The type to capture a USM pointer as in a SYCL kernel function. ComputeCpp
+ * requires USM pointers to be wrapped in a usm_wrapper, other implementations
+ * can capture the raw pointer. */
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+template <typename T>
+using usm_pointer = cl::sycl::experimental::usm_wrapper<T>;
+#else
+template <typename T>
+using usm_pointer = T*;
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+template <typename T>
+usm_pointer<T> make_usm_pointer(T* ptr) {
+  return usm_pointer<T>{ptr};
+}
+
+}  // namespace cppcon
+
+#endif  // __USM_POINTER_H__
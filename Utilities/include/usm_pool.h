@@ -0,0 +1,363 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __USM_POOL_H__
+#define __USM_POOL_H__
+
+/* See usm_pointer.h for the includes required when using ComputeCpp. */
+#include <usm_pointer.h>
+
+#include <memory_footprint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+namespace cppcon {
+
+enum class usm_kind { device, host, shared };
+
+namespace detail {
+
+/* ComputeCpp provides USM in the experimental namespace. */
+#ifdef SYCL_ACADEMY_USING_COMPUTECPP
+namespace usm_api = cl::sycl::experimental;
+#else
+namespace usm_api = cl::sycl;
+#endif  // SYCL_ACADEMY_USING_COMPUTECPP
+
+inline void* usm_malloc(size_t bytes, const cl::sycl::queue& queue,
+                        usm_kind kind) {
+  switch (kind) {
+    case usm_kind::host:
+      return usm_api::malloc_host(bytes, queue);
+    case usm_kind::shared:
+      return usm_api::malloc_shared(bytes, queue);
+    default:
+      return usm_api::malloc_device(bytes, queue);
+  }
+}
+
+inline void usm_free(void* ptr, const cl::sycl::queue& queue) {
+  usm_api::free(ptr, queue);
+}
+
+inline memory_kind to_memory_kind(usm_kind kind) {
+  switch (kind) {
+    case usm_kind::host:
+      return memory_kind::usm_host;
+    case usm_kind::shared:
+      return memory_kind::usm_shared;
+    default:
+      return memory_kind::usm_device;
+  }
+}
+
+}  // namespace detail
+
+/* A standard allocator of USM memory of one kind, bound to a queue, which
+ * registers every allocation with the memory_tracker, so that the benchmarks
+ * report the USM footprint. Host and shared allocations can back containers,
+ * e.g. std::vector<float, tracking_usm_allocator<float>>, and device
+ * allocations can be made directly with allocate and deallocate. */
+template <typename T>
+class tracking_usm_allocator {
+ public:
+  using value_type = T;
+
+  explicit tracking_usm_allocator(cl::sycl::queue queue,
+                                  usm_kind kind = usm_kind::device)
+      : queue_{std::move(queue)}, kind_{kind} {}
+
+  template <typename U>
+  tracking_usm_allocator(const tracking_usm_allocator<U>& other)
+      : queue_{other.get_queue()}, kind_{other.get_kind()} {}
+
+  T* allocate(size_t count) {
+    const size_t bytes = count * sizeof(T);
+    void* ptr = detail::usm_malloc(bytes, queue_, kind_);
+    if (!ptr) {
+      throw std::bad_alloc{};
+    }
+    memory_tracker::instance().allocated(bytes, detail::to_memory_kind(kind_));
+    return static_cast<T*>(ptr);
+  }
+
+  void deallocate(T* ptr, size_t count) {
+    detail::usm_free(ptr, queue_);
+    memory_tracker::instance().deallocated(count * sizeof(T),
+                                           detail::to_memory_kind(kind_));
+  }
+
+  const cl::sycl::queue& get_queue() const noexcept { return queue_; }
+  usm_kind get_kind() const noexcept { return kind_; }
+
+  template <typename U>
+  bool operator==(const tracking_usm_allocator<U>& other) const {
+    return queue_.get_context() == other.get_queue().get_context() &&
+           kind_ == other.get_kind();
+  }
+
+  template <typename U>
+  bool operator!=(const tracking_usm_allocator<U>& other) const {
+    return !(*this == other);
+  }
+
+ private:
+  cl::sycl::queue queue_;
+  usm_kind kind_;
+};
+
+struct usm_pool_stats {
+  size_t requests = 0;
+  size_t hits = 0;
+  size_t bytesInUse = 0;
+  size_t peakBytesInUse = 0;
+  /* Bytes currently allocated from the device, in use or cached. */
+  size_t bytesReserved = 0;
+
+  double hit_rate() const {
+    return requests ? static_cast<double>(hits) / requests : 0.0;
+  }
+};
+
+/* A caching allocator for USM memory of one kind, bound to a queue.
+ *
+ * Requests are rounded up to a size class and freed blocks are kept on a free
+ * list per size class, so that repeated allocations of similar sizes are
+ * served without calling into the SYCL runtime. Size classes are powers of two
+ * from 256 bytes, each split into four steps, which wastes at most a quarter of
+ * a block.
+ *
+ * As with free, a block must not be deallocated while work using it may still
+ * be running. Any blocks still allocated when the pool is destroyed are freed
+ * with it. */
+class usm_pool {
+ public:
+  struct deleter {
+    usm_pool* pool;
+    void operator()(void* ptr) const { pool->deallocate(ptr); }
+  };
+
+  template <typename T>
+  using unique_ptr = std::unique_ptr<T, deleter>;
+
+  static constexpr size_t min_block_size = 256;
+
+  explicit usm_pool(cl::sycl::queue queue, usm_kind kind = usm_kind::device)
+      : queue_{std::move(queue)}, kind_{kind} {}
+
+  usm_pool(const usm_pool&) = delete;
+  usm_pool& operator=(const usm_pool&) = delete;
+
+  ~usm_pool() {
+    trim();
+    for (auto& block : inUse_) {
+      detail::usm_free(block.first, queue_);
+      memory_tracker::instance().deallocated(block.second,
+                                             detail::to_memory_kind(kind_));
+    }
+  }
+
+  static size_t size_class(size_t bytes) {
+    if (bytes <= min_block_size) {
+      return min_block_size;
+    }
+    size_t power = min_block_size;
+    while (power * 2 <= bytes) {
+      power *= 2;
+    }
+    const size_t step = power / 4;
+    return ((bytes + step - 1) / step) * step;
+  }
+
+  void* allocate_bytes(size_t bytes) {
+    const size_t blockSize = size_class(bytes);
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    ++stats_.requests;
+
+    void* ptr = nullptr;
+    auto freeList = free_.find(blockSize);
+    if (freeList != free_.end() && !freeList->second.empty()) {
+      ptr = freeList->second.back();
+      freeList->second.pop_back();
+      ++stats_.hits;
+    } else {
+      ptr = detail::usm_malloc(blockSize, queue_, kind_);
+      if (!ptr) {
+        /* The device may be out of memory only because of cached blocks. */
+        trim_locked();
+        ptr = detail::usm_malloc(blockSize, queue_, kind_);
+        if (!ptr) {
+          throw std::bad_alloc{};
+        }
+      }
+      stats_.bytesReserved += blockSize;
+      memory_tracker::instance().allocated(blockSize,
+                                           detail::to_memory_kind(kind_));
+    }
+
+    inUse_.emplace(ptr, blockSize);
+    stats_.bytesInUse += blockSize;
+    stats_.peakBytesInUse = std::max(stats_.peakBytesInUse, stats_.bytesInUse);
+    return ptr;
+  }
+
+  template <typename T>
+  T* allocate(size_t count) {
+    return static_cast<T*>(allocate_bytes(count * sizeof(T)));
+  }
+
+  template <typename T>
+  unique_ptr<T> make_unique(size_t count) {
+    return unique_ptr<T>{allocate<T>(count), deleter{this}};
+  }
+
+  /* Returns a block to its free list. */
+  void deallocate(void* ptr) {
+    if (!ptr) {
+      return;
+    }
+
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto block = inUse_.find(ptr);
+    if (block == inUse_.end()) {
+      return;
+    }
+    free_[block->second].push_back(ptr);
+    stats_.bytesInUse -= block->second;
+    inUse_.erase(block);
+  }
+
+  /* Frees every cached block back to the device. */
+  void trim() {
+    std::lock_guard<std::mutex> lock{mutex_};
+    trim_locked();
+  }
+
+  usm_pool_stats stats() const {
+    std::lock_guard<std::mutex> lock{mutex_};
+    return stats_;
+  }
+
+  cl::sycl::queue& get_queue() noexcept { return queue_; }
+  usm_kind get_kind() const noexcept { return kind_; }
+
+ private:
+  void trim_locked() {
+    for (auto& freeList : free_) {
+      for (auto ptr : freeList.second) {
+        detail::usm_free(ptr, queue_);
+        stats_.bytesReserved -= freeList.first;
+        memory_tracker::instance().deallocated(freeList.first,
+                                               detail::to_memory_kind(kind_));
+      }
+    }
+    free_.clear();
+  }
+
+  cl::sycl::queue queue_;
+  usm_kind kind_;
+  mutable std::mutex mutex_;
+  std::map<size_t, std::vector<void*>> free_;
+  std::unordered_map<void*, size_t> inUse_;
+  usm_pool_stats stats_;
+};
+
+/* A bump allocator for scratch memory which only lives for one iteration.
+ * Allocations are carved out of slabs taken from a usm_pool and are all
+ * released at once by reset. If an iteration outgrows the slab, further slabs
+ * are added, and on reset they are replaced by a single slab large enough for
+ * the whole iteration, so that later iterations need only one. */
+class usm_arena {
+ public:
+  static constexpr size_t alignment = 64;
+
+  usm_arena(usm_pool& pool, size_t capacity)
+      : pool_{pool}, capacity_{std::max<size_t>(capacity, alignment)} {
+    add_slab(capacity_);
+  }
+
+  usm_arena(const usm_arena&) = delete;
+  usm_arena& operator=(const usm_arena&) = delete;
+
+  ~usm_arena() { release_slabs(); }
+
+  void* allocate_bytes(size_t bytes) {
+    bytes = ((bytes + alignment - 1) / alignment) * alignment;
+
+    if (offset_ + bytes > slabs_.back().size) {
+      used_ += offset_;
+      offset_ = 0;
+      add_slab(std::max(bytes, capacity_));
+    }
+
+    void* ptr = static_cast<char*>(slabs_.back().ptr) + offset_;
+    offset_ += bytes;
+    return ptr;
+  }
+
+  template <typename T>
+  T* allocate(size_t count) {
+    return static_cast<T*>(allocate_bytes(count * sizeof(T)));
+  }
+
+  /* Releases every allocation. As with usm_pool::deallocate, no work using
+   * them may still be running. */
+  void reset() {
+    if (slabs_.size() > 1) {
+      capacity_ = std::max(capacity_, used());
+      release_slabs();
+      add_slab(capacity_);
+    }
+    used_ = 0;
+    offset_ = 0;
+  }
+
+  /* Bytes allocated since the last reset. */
+  size_t used() const noexcept { return used_ + offset_; }
+  size_t capacity() const noexcept { return capacity_; }
+
+ private:
+  struct slab {
+    void* ptr;
+    size_t size;
+  };
+
+  void add_slab(size_t size) {
+    slabs_.push_back(slab{pool_.allocate_bytes(size), size});
+  }
+
+  void release_slabs() {
+    for (auto& s : slabs_) {
+      pool_.deallocate(s.ptr);
+    }
+    slabs_.clear();
+  }
+
+  usm_pool& pool_;
+  size_t capacity_;
+  std::vector<slab> slabs_;
+  /* Bytes allocated from slabs before the current one. */
+  size_t used_ = 0;
+  size_t offset_ = 0;
+};
+
+}  // namespace cppcon
+
+#endif  // __USM_POOL_H__
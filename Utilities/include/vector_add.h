@@ -0,0 +1,152 @@
+/*
+ SYCL Academy (c)
+
+ SYCL Academy is licensed under a Creative Commons
+ Attribution-ShareAlike 4.0 International License.
+
+ You should have received a copy of the license along with this
+ work.  If not, see <http://creativecommons.org/licenses/by-sa/4.0/>.
+*/
+
+#ifndef __VECTOR_ADD_H__
+#define __VECTOR_ADD_H__
+
+#include <async_result.h>
+#include <execution_context.h>
+#include <memory_footprint.h>
+
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <CL/sycl.hpp>
+
+/* The buffer vector add of the Exercise 4 solution, shared by the benchmarks
+ * which compare ways of running it, so that they all time the same kernel. */
+
+namespace cppcon {
+
+template <typename T>
+class vector_add_kernel;
+
+template <typename T>
+class vector_add_context_kernel;
+
+template <typename T>
+class vector_add_async_kernel;
+
+/* Throws std::invalid_argument unless the vectors are the same size. This is
+ * checked rather than asserted, as the benchmarks are built with NDEBUG. */
+template <typename T>
+void check_vector_add_sizes(const std::vector<T>& inputA,
+                            const std::vector<T>& inputB,
+                            const std::vector<T>& output) {
+  if (inputA.size() != inputB.size() || inputA.size() != output.size()) {
+    throw std::invalid_argument("parallel_add: vectors differ in size");
+  }
+}
+
+/* Adds the elements [offset, offset + count) on the given queue. The buffers
+ * only cover that part of the vectors, and block until it has been written
+ * back to output when they are destroyed at the end of the function. */
+template <typename T>
+void parallel_add(cl::sycl::queue& queue, const std::vector<T>& inputA,
+                  const std::vector<T>& inputB, std::vector<T>& output,
+                  size_t offset, size_t count) {
+  using namespace cl::sycl;
+
+  check_vector_add_sizes(inputA, inputB, output);
+  if (offset + count > output.size()) {
+    throw std::out_of_range("parallel_add: part is outside the vectors");
+  }
+
+  tracked_buffer<T, 1> inputABuf(inputA.data() + offset, range<1>(count));
+  tracked_buffer<T, 1> inputBBuf(inputB.data() + offset, range<1>(count));
+  tracked_buffer<T, 1> outputBuf(output.data() + offset, range<1>(count));
+
+  queue.submit([&](handler& cgh) {
+    auto inputAAcc = inputABuf.template get_access<access::mode::read>(cgh);
+    auto inputBAcc = inputBBuf.template get_access<access::mode::read>(cgh);
+    auto outputAcc =
+        outputBuf.template get_access<access::mode::discard_write>(cgh);
+
+    cgh.parallel_for<vector_add_kernel<T>>(range<1>(count), [=](id<1> i) {
+      outputAcc[i] = inputAAcc[i] + inputBAcc[i];
+    });
+  });
+}
+
+template <typename T>
+void parallel_add(cl::sycl::queue& queue, const std::vector<T>& inputA,
+                  const std::vector<T>& inputB, std::vector<T>& output) {
+  parallel_add(queue, inputA, inputB, output, 0, output.size());
+}
+
+/* The same, but the queue, context and compiled kernel come from an
+ * execution_context which outlives the call. */
+template <typename T>
+void parallel_add(execution_context& ctx, const std::vector<T>& inputA,
+                  const std::vector<T>& inputB, std::vector<T>& output) {
+  using namespace cl::sycl;
+
+  check_vector_add_sizes(inputA, inputB, output);
+  const auto size = output.size();
+
+  tracked_buffer<T, 1> inputABuf(inputA.data(), range<1>(size));
+  tracked_buffer<T, 1> inputBBuf(inputB.data(), range<1>(size));
+  tracked_buffer<T, 1> outputBuf(output.data(), range<1>(size));
+
+  ctx.get_queue().submit([&](handler& cgh) {
+    auto inputAAcc = inputABuf.template get_access<access::mode::read>(cgh);
+    auto inputBAcc = inputBBuf.template get_access<access::mode::read>(cgh);
+    auto outputAcc =
+        outputBuf.template get_access<access::mode::discard_write>(cgh);
+
+    ctx.parallel_for<vector_add_context_kernel<T>>(
+        cgh, range<1>(size), [=](id<1> i) {
+          outputAcc[i] = inputAAcc[i] + inputBAcc[i];
+        });
+  });
+}
+
+/* Returns as soon as the kernel is submitted. The returned async_result owns
+ * the buffers, so the inputs and output must stay alive until it has been
+ * waited on, at which point output holds the result. */
+template <typename T>
+async_result parallel_add_async(cl::sycl::queue& queue,
+                                const std::vector<T>& inputA,
+                                const std::vector<T>& inputB,
+                                std::vector<T>& output) {
+  using namespace cl::sycl;
+
+  check_vector_add_sizes(inputA, inputB, output);
+  const auto size = output.size();
+
+  struct buffers {
+    tracked_buffer<T, 1> inputA;
+    tracked_buffer<T, 1> inputB;
+    tracked_buffer<T, 1> output;
+  };
+
+  auto bufs = std::make_shared<buffers>(
+      buffers{tracked_buffer<T, 1>(inputA.data(), range<1>(size)),
+              tracked_buffer<T, 1>(inputB.data(), range<1>(size)),
+              tracked_buffer<T, 1>(output.data(), range<1>(size))});
+
+  auto event = queue.submit([&](handler& cgh) {
+    auto inputAAcc = bufs->inputA.template get_access<access::mode::read>(cgh);
+    auto inputBAcc = bufs->inputB.template get_access<access::mode::read>(cgh);
+    auto outputAcc =
+        bufs->output.template get_access<access::mode::discard_write>(cgh);
+
+    cgh.parallel_for<vector_add_async_kernel<T>>(
+        range<1>(size),
+        [=](id<1> i) { outputAcc[i] = inputAAcc[i] + inputBAcc[i]; });
+  });
+
+  return async_result{event, bufs};
+}
+
+}  // namespace cppcon
+
+#endif  // __VECTOR_ADD_H__